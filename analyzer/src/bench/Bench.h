@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Module.h>
+
+// A benchmark body runs its kernel `iterations` times.
+using BenchmarkBody = std::function<void(unsigned int iterations)>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkBody body;
+};
+
+std::vector<Benchmark>& benchmarkRegistry();
+
+struct BenchmarkRegistrar {
+    BenchmarkRegistrar(const char* name, BenchmarkBody body) {
+        benchmarkRegistry().push_back(Benchmark {name, std::move(body)});
+    }
+};
+
+#define BENCHMARK_CONCAT_INNER(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_INNER(a, b)
+// The body is variadic because lambdas may contain top-level commas.
+#define BENCHMARK(name, ...) \
+    static BenchmarkRegistrar BENCHMARK_CONCAT(benchmarkRegistrar, __LINE__)(name, __VA_ARGS__)
+
+// Parses textual IR into a module of a context that lives until exit, exits on parse errors.
+std::unique_ptr<llvm::Module> parseBenchmarkModule(llvm::StringRef ir);
+
+// Keeps the compiler from optimizing away a computed value.
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
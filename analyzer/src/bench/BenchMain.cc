@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <ctime>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Bench.h"
+
+using namespace llvm;
+
+static cl::opt<unsigned> Iterations("iterations", cl::desc("Iterations per repetition, 0 to calibrate them with --min-time"), cl::init(0));
+static cl::opt<unsigned> MinTime("min-time", cl::desc("Minimum CPU time of a repetition in milliseconds, when calibrating the iterations"), cl::init(50));
+static cl::opt<unsigned> Repetitions("repetitions", cl::desc("Repetitions per benchmark, the median is reported"), cl::init(7));
+static cl::opt<std::string> Filter("filter", cl::desc("Only run benchmarks whose name contains this substring"), cl::init(""));
+static cl::opt<std::string> SaveBaseline("save-baseline", cl::desc("Write the fastest repetition of every benchmark to this file"), cl::init(""));
+static cl::opt<std::string> Baseline("baseline", cl::desc("Compare the fastest repetitions to those in this file, written by --save-baseline"), cl::init(""));
+static cl::opt<double> MaxRegression("max-regression", cl::desc("Exit with 1 when a fastest repetition is this many percent slower than its baseline"), cl::init(15.0));
+
+std::vector<Benchmark>& benchmarkRegistry() {
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+std::unique_ptr<Module> parseBenchmarkModule(StringRef ir) {
+    static LLVMContext context;
+    SMDiagnostic error;
+    auto module = parseAssemblyString(ir, error, context);
+    if (!module) {
+        error.print("kanalyzer-bench", errs());
+        exit(1);
+    }
+    return module;
+}
+
+// CPU time of the calling thread, such that time spent on other processes of a busy machine is not counted
+static double threadNanoseconds() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) * 1e9 + static_cast<double>(time.tv_nsec);
+}
+
+static double runNanoseconds(const Benchmark& benchmark, unsigned int iterations) {
+    auto start = threadNanoseconds();
+    benchmark.body(iterations);
+    return threadNanoseconds() - start;
+}
+
+// Baseline files have a line "<name> <fastest ns/op>" per benchmark
+static bool readBaseline(StringRef path, StringMap<double>& medians) {
+    auto buffer = MemoryBuffer::getFile(path);
+    if (!buffer) {
+        errs() << "Could not read the baseline " << path << ": " << buffer.getError().message() << "\n";
+        return false;
+    }
+    SmallVector<StringRef, 64> lines;
+    (*buffer)->getBuffer().split(lines, '\n', -1, false);
+    for (auto line : lines) {
+        auto [name, median] = line.rsplit(' ');
+        double value;
+        if (!median.getAsDouble(value))
+            medians[name] = value;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    cl::ParseCommandLineOptions(argc, argv, "kanalyzer microbenchmarks\n");
+
+    auto& registry = benchmarkRegistry();
+    std::sort(registry.begin(), registry.end(), [](const Benchmark& a, const Benchmark& b) {
+        return a.name < b.name;
+    });
+
+    StringMap<double> baseline;
+    if (!Baseline.empty() && !readBaseline(Baseline, baseline))
+        return 1;
+    std::string savedBaseline;
+    bool regressed = false;
+
+    std::vector<const Benchmark*> selected;
+    for (const auto& benchmark : registry) {
+        if (Filter.empty() || benchmark.name.find(Filter) != std::string::npos)
+            selected.push_back(&benchmark);
+    }
+
+    // Warm-up, fills caches and memo tables. Without fixed iterations, doubles them until a repetition takes
+    // long enough for the timer resolution and the scheduler to not matter.
+    std::vector<unsigned int> iterations;
+    for (const auto* benchmark : selected) {
+        unsigned int count = std::max(1u, Iterations.getValue());
+        auto warmUp = runNanoseconds(*benchmark, count);
+        while (Iterations == 0 && warmUp < MinTime * 1e6 && count < (1u << 30)) {
+            count *= 2;
+            warmUp = runNanoseconds(*benchmark, count);
+        }
+        iterations.push_back(count);
+    }
+
+    // Repetitions are interleaved across the benchmarks, such that a slow period of the machine affects one
+    // repetition of several benchmarks rather than all repetitions of one.
+    unsigned int repetitions = std::max(1u, Repetitions.getValue());
+    std::vector<std::vector<double>> measurements(selected.size());
+    for (unsigned int repetition = 0; repetition < repetitions; ++repetition) {
+        for (size_t i = 0; i < selected.size(); ++i)
+            measurements[i].push_back(runNanoseconds(*selected[i], iterations[i]) / iterations[i]);
+    }
+
+    for (size_t i = 0; i < selected.size(); ++i) {
+        const auto& benchmark = *selected[i];
+        auto& nanosecondsPerIteration = measurements[i];
+        std::sort(nanosecondsPerIteration.begin(), nanosecondsPerIteration.end());
+        double median = nanosecondsPerIteration[nanosecondsPerIteration.size() / 2];
+        double fastest = nanosecondsPerIteration.front();
+        double spread = nanosecondsPerIteration.back() - nanosecondsPerIteration.front();
+        outs() << format("%-48s %12.1f ns/op  (min %.1f, max %.1f, spread %.1f%%)",
+                         benchmark.name.c_str(), median, nanosecondsPerIteration.front(),
+                         nanosecondsPerIteration.back(), median > 0 ? spread / median * 100.0 : 0.0);
+        // The fastest repetition is the least disturbed by the rest of the machine, so it is the one compared
+        if (auto it = baseline.find(benchmark.name); it != baseline.end() && it->second > 0) {
+            double change = (fastest / it->second - 1.0) * 100.0;
+            outs() << format("  %+.1f%% vs baseline", change);
+            if (change > MaxRegression) {
+                outs() << "  REGRESSION";
+                regressed = true;
+            }
+        }
+        outs() << "\n";
+        savedBaseline += benchmark.name + " " + std::to_string(fastest) + "\n";
+    }
+
+    if (!SaveBaseline.empty()) {
+        std::error_code error;
+        raw_fd_ostream out(SaveBaseline, error);
+        if (error) {
+            errs() << "Could not write the baseline " << SaveBaseline << ": " << error.message() << "\n";
+            return 1;
+        }
+        out << savedBaseline;
+    }
+
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#include "Bench.h"
+#include "Common.h"
+
+// A handler signature and a structure as MLTA hashes them for every call and type confinement
+static const char* hashIR = R"(
+%struct.inner = type { i32, i32 }
+%struct.context = type { i32, i8*, %struct.inner*, [16 x i8], i64 (i8*)*, i64 }
+
+define i32 @handle_request(%struct.context* %ctx, i8* %buffer, i64 %length) {
+  ret i32 0
+}
+)";
+
+static Module& hashModule() {
+    static auto module = parseBenchmarkModule(hashIR);
+    CurrentLayout = &module->getDataLayout();
+    return *module;
+}
+
+BENCHMARK("hash/funcHash", [](unsigned int iterations) {
+    auto function = hashModule().getFunction("handle_request");
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = funcHash(function);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("hash/funcHash without name", [](unsigned int iterations) {
+    auto function = hashModule().getFunction("handle_request");
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = funcHash(function, false);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("hash/typeHash struct", [](unsigned int iterations) {
+    auto type = StructType::getTypeByName(hashModule().getContext(), "struct.context");
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = typeHash(type);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("hash/typeHash integer", [](unsigned int iterations) {
+    auto type = Type::getInt64Ty(hashModule().getContext());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = typeHash(type);
+        doNotOptimize(result);
+    }
+});
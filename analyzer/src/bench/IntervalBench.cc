@@ -0,0 +1,143 @@
+#include <climits>
+#include "Bench.h"
+#include "Interval.h"
+#include "IntervalPool.h"
+
+using llvm::ICmpInst;
+
+// The intervals that dominate real runs
+static Interval negative() {
+    Interval interval(false);
+    interval.applyInequalityOperator(ICmpInst::Predicate::ICMP_SLT, 0);
+    return interval;
+}
+
+static Interval zero() {
+    Interval interval(false);
+    interval.applyInequalityOperator(ICmpInst::Predicate::ICMP_EQ, 0);
+    return interval;
+}
+
+static Interval nonZero() {
+    Interval interval(false);
+    interval.applyInequalityOperator(ICmpInst::Predicate::ICMP_NE, 0);
+    return interval;
+}
+
+static const ICmpInst::Predicate predicates[] = {
+    ICmpInst::Predicate::ICMP_EQ, ICmpInst::Predicate::ICMP_NE,
+    ICmpInst::Predicate::ICMP_SLT, ICmpInst::Predicate::ICMP_SLE,
+    ICmpInst::Predicate::ICMP_SGT, ICmpInst::Predicate::ICMP_SGE,
+};
+
+BENCHMARK("interval/applyInequalityOperator", [](unsigned int iterations) {
+    for (unsigned int i = 0; i < iterations; ++i) {
+        Interval interval(false);
+        interval.applyInequalityOperator(predicates[i % 6], static_cast<int>(i % 3) - 1);
+        doNotOptimize(interval);
+    }
+});
+
+BENCHMARK("interval/unionInPlace", [](unsigned int iterations) {
+    auto a = negative(), b = zero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        Interval accumulation(true);
+        accumulation.unionInPlace(a);
+        accumulation.unionInPlace(b);
+        doNotOptimize(accumulation);
+    }
+});
+
+BENCHMARK("interval/intersectionInPlace", [](unsigned int iterations) {
+    auto a = negative(), b = nonZero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        Interval accumulation = b;
+        accumulation.intersectionInPlace(a);
+        doNotOptimize(accumulation);
+    }
+});
+
+BENCHMARK("interval/complement", [](unsigned int iterations) {
+    auto a = nonZero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = a.complement();
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("interval/isSubsetOf", [](unsigned int iterations) {
+    auto a = negative(), b = nonZero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        bool result = a.isSubsetOf(b);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("interval/hash", [](unsigned int iterations) {
+    auto a = nonZero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = IntervalHash()(a);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("pool/fromPredicate", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto ref = pool.fromPredicate(predicates[i % 6], static_cast<int>(i % 3) - 1);
+        doNotOptimize(ref);
+    }
+});
+
+BENCHMARK("pool/intern", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    auto a = nonZero();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto ref = pool.intern(a);
+        doNotOptimize(ref);
+    }
+});
+
+BENCHMARK("pool/union", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    auto a = pool.intern(negative()), b = pool.intern(zero());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto ref = pool.union_(pool.union_(pool.empty(), a), b);
+        doNotOptimize(ref);
+    }
+});
+
+BENCHMARK("pool/intersection", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    auto a = pool.intern(negative()), b = pool.intern(nonZero());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto ref = pool.intersection(b, a);
+        doNotOptimize(ref);
+    }
+});
+
+BENCHMARK("pool/complement", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    auto a = pool.intern(nonZero());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto ref = pool.complement(a);
+        doNotOptimize(ref);
+    }
+});
+
+BENCHMARK("pool/isSubsetOf", [](unsigned int iterations) {
+    auto& pool = IntervalPool::get();
+    auto a = pool.intern(negative()), b = pool.intern(nonZero());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        bool result = pool.isSubsetOf(a, b);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("pool/hash", [](unsigned int iterations) {
+    auto a = IntervalPool::get().intern(nonZero());
+    for (unsigned int i = 0; i < iterations; ++i) {
+        auto result = IntervalRefHash()(a);
+        doNotOptimize(result);
+    }
+});
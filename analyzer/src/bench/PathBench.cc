@@ -0,0 +1,146 @@
+#include <string>
+#include "Bench.h"
+#include "DataFlowAnalysis.h"
+#include "EHBlockDetector.h"
+
+// Error block that switches over 16 cases, each a chain of 8 blocks to a return: 16 paths of 10 blocks
+static std::string switchFanOutIR() {
+    std::string ir = "define i32 @fanout(i32 %x) {\n"
+                     "entry:\n"
+                     "  %c = icmp slt i32 %x, 0\n"
+                     "  br i1 %c, label %error, label %ok\n"
+                     "ok:\n"
+                     "  ret i32 0\n"
+                     "error:\n"
+                     "  switch i32 %x, label %case0_0 [";
+    for (int k = 1; k < 16; ++k)
+        ir += " i32 -" + std::to_string(k) + ", label %case" + std::to_string(k) + "_0";
+    ir += " ]\n";
+    for (int k = 0; k < 16; ++k) {
+        for (int j = 0; j < 8; ++j) {
+            auto block = "case" + std::to_string(k) + "_" + std::to_string(j);
+            ir += block + ":\n";
+            if (j < 7)
+                ir += "  br label %case" + std::to_string(k) + "_" + std::to_string(j + 1) + "\n";
+            else
+                ir += "  ret i32 -" + std::to_string(k + 1) + "\n";
+        }
+    }
+    return ir + "}\n";
+}
+
+// Error block followed by a chain of 32 OR-conditions that share the failure block: 33 paths
+static std::string orChainIR() {
+    std::string ir = "define i32 @orchain(i32 %x, i1 %c) {\n"
+                     "entry:\n"
+                     "  br i1 %c, label %error, label %ok\n"
+                     "ok:\n"
+                     "  ret i32 0\n"
+                     "fail:\n"
+                     "  ret i32 -1\n"
+                     "error:\n"
+                     "  br label %or0\n";
+    for (int k = 0; k < 32; ++k) {
+        auto index = std::to_string(k);
+        ir += "or" + index + ":\n"
+              "  %c" + index + " = icmp eq i32 %x, " + index + "\n"
+              "  br i1 %c" + index + ", label %fail, label %or" + std::to_string(k + 1) + "\n";
+    }
+    return ir + "or32:\n  ret i32 -2\n}\n";
+}
+
+static const BasicBlock* findBlock(const Function& function, StringRef name) {
+    for (const auto& block : function) {
+        if (block.getName() == name)
+            return &block;
+    }
+    return nullptr;
+}
+
+// Mirrors the path collection of EHBlockDetectorPass::stage0 from the check in the entry block
+static void benchmarkCollectPaths(const Function& function, unsigned int iterations) {
+    auto entry = &function.getEntryBlock();
+    auto error = findBlock(function, "error");
+    set<const BasicBlock*> checksBlocks {findBlock(function, "ok")};
+    for (unsigned int i = 0; i < iterations; ++i) {
+        vector<Path*> allPaths;
+        auto path = new Path();
+        path->blocks.push_back(entry);
+        allPaths.push_back(path);
+        EHBlockDetectorPass::collectPaths(error, allPaths, path, checksBlocks);
+        doNotOptimize(allPaths.size());
+        for (auto* collected : allPaths)
+            delete collected;
+    }
+}
+
+BENCHMARK("paths/collectPaths switch fan-out", [](unsigned int iterations) {
+    static auto module = parseBenchmarkModule(switchFanOutIR());
+    benchmarkCollectPaths(*module->getFunction("fanout"), iterations);
+});
+
+BENCHMARK("paths/collectPaths or-chain", [](unsigned int iterations) {
+    static auto module = parseBenchmarkModule(orChainIR());
+    benchmarkCollectPaths(*module->getFunction("orchain"), iterations);
+});
+
+// The stores on both sides of the branch make the loaded value path dependent, and the path continues through
+// 16 blocks with stores to another slot before the value is returned.
+static std::string resolutionIR() {
+    std::string ir = "define i32 @resolve(i1 %c) {\n"
+                     "entry:\n"
+                     "  %slot = alloca i32\n"
+                     "  %other = alloca i32\n"
+                     "  store i32 0, i32* %slot\n"
+                     "  br i1 %c, label %a, label %b\n"
+                     "a:\n"
+                     "  store i32 -5, i32* %slot\n"
+                     "  br label %join\n"
+                     "b:\n"
+                     "  store i32 3, i32* %slot\n"
+                     "  br label %join\n"
+                     "join:\n"
+                     "  %phi = phi i32 [ -12, %a ], [ 0, %b ]\n"
+                     "  %v = load i32, i32* %slot\n"
+                     "  %wide = sext i32 %v to i64\n"
+                     "  %narrow = trunc i64 %wide to i32\n"
+                     "  br label %l0\n";
+    for (int k = 0; k < 16; ++k) {
+        auto index = std::to_string(k);
+        ir += "l" + index + ":\n"
+              "  store i32 " + index + ", i32* %other\n"
+              "  br label %l" + std::to_string(k + 1) + "\n";
+    }
+    return ir + "l16:\n"
+                "  ret i32 %narrow\n"
+                "}\n";
+}
+
+static void benchmarkResolution(StringRef valueName, unsigned int iterations) {
+    static auto module = parseBenchmarkModule(resolutionIR());
+    auto& function = *module->getFunction("resolve");
+    vector<const BasicBlock*> blocks;
+    for (const auto& block : function) {
+        if (block.getName() != "b")
+            blocks.push_back(&block);
+    }
+    const Value* value = nullptr;
+    for (const auto& instruction : *findBlock(function, "join")) {
+        if (instruction.getName() == valueName)
+            value = &instruction;
+    }
+    auto origin = findBlock(function, "l16")->getTerminator();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        PHISet phiSet;
+        auto resolved = DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(value, origin, PathSpan {blocks, false}, phiSet);
+        doNotOptimize(resolved);
+    }
+}
+
+BENCHMARK("paths/findUndisputedValue load", [](unsigned int iterations) {
+    benchmarkResolution("narrow", iterations);
+});
+
+BENCHMARK("paths/findUndisputedValue phi", [](unsigned int iterations) {
+    benchmarkResolution("phi", iterations);
+});
@@ -0,0 +1,69 @@
+#include <string>
+#include "Bench.h"
+#include "EHBlockDetector.h"
+
+// Path summaries as stage0 compares them: calls to a handful of functions, and returns of constants
+struct SummaryFixture {
+    std::unique_ptr<Module> module;
+    vector<FlatFuncSet> targets;
+    Summary longer, subsequence, diverging;
+
+    SummaryFixture() {
+        std::string ir;
+        for (int k = 0; k < 8; ++k)
+            ir += "declare i32 @callee" + std::to_string(k) + "()\n";
+        module = parseBenchmarkModule(ir);
+        // Reserved up front, the operations point into it
+        targets.reserve(8);
+        for (int k = 0; k < 8; ++k)
+            targets.push_back(FlatFuncSet {module->getFunction("callee" + std::to_string(k))});
+
+        auto minusOne = ConstantInt::getSigned(Type::getInt32Ty(module->getContext()), -1);
+        for (unsigned int k = 0; k < 48; ++k) {
+            auto call = Operation {
+                .type = OperationType::Call,
+                .predicate = {},
+                .callTargets = &targets[(k * 5) % 8],
+            };
+            longer.ops.push_back(call);
+            if (k % 4 != 0)
+                subsequence.ops.push_back(call);
+            // Differs in an operation that the subsequence keeps, such that it is not a subsequence of this one
+            diverging.ops.push_back(k == 41 ? Operation {.type = OperationType::Call, .predicate = {}, .callTargets = &targets[(k * 5 + 1) % 8]} : call);
+        }
+        auto ret = Operation {
+            .type = OperationType::Return,
+            .predicate = {},
+            .returnData = {
+                .resolvedValue = minusOne,
+                .unresolvedValue = minusOne,
+            }
+        };
+        longer.ops.push_back(ret);
+        subsequence.ops.push_back(ret);
+        diverging.ops.push_back(ret);
+    }
+};
+
+static const SummaryFixture& summaryFixture() {
+    static SummaryFixture fixture;
+    return fixture;
+}
+
+BENCHMARK("summary/isEitherSubsequenceOfTheOther match", [](unsigned int iterations) {
+    const auto& fixture = summaryFixture();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        unsigned short lcs;
+        bool result = isEitherSubsequenceOfTheOther(fixture.longer.ops, fixture.subsequence.ops, lcs);
+        doNotOptimize(result);
+    }
+});
+
+BENCHMARK("summary/isEitherSubsequenceOfTheOther mismatch", [](unsigned int iterations) {
+    const auto& fixture = summaryFixture();
+    for (unsigned int i = 0; i < iterations; ++i) {
+        unsigned short lcs;
+        bool result = isEitherSubsequenceOfTheOther(fixture.diverging.ops, fixture.subsequence.ops, lcs);
+        doNotOptimize(result);
+    }
+});
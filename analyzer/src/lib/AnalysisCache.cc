@@ -0,0 +1,151 @@
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/xxhash.h>
+#include "AnalysisCache.h"
+#include "BinaryReader.h"
+#include "Analyzer.h"
+#include "ClOptForward.h"
+
+namespace {
+
+constexpr char Magic[8] = {'E', 'S', 'S', 'S', 'P', 'A', 'T', 'H'};
+constexpr uint32_t Version = 1;
+
+}
+
+std::atomic<size_t> ModuleAnalysisCache::hits {0}, ModuleAnalysisCache::misses {0};
+
+string computeContentHash(StringRef contents) {
+    return toHex(SHA1::hash(arrayRefFromStringRef(contents)), /* LowerCase */ true);
+}
+
+uint64_t pathAnalysisKey(const Function& function) {
+    // Hashed with a stable hash function, the key must be the same across runs
+    string identities;
+    raw_string_ostream out(identities);
+    for (const auto& instruction : instructions(function)) {
+        auto call = dyn_cast<CallInst>(&instruction);
+        if (!call)
+            continue;
+        auto calleesIt = GlobalCtx.Callees.find(const_cast<CallInst*>(call));
+        if (calleesIt == GlobalCtx.Callees.end()) {
+            out << ";";
+            continue;
+        }
+        for (const auto* callee : calleesIt->second) {
+            out << callee->getName();
+            // Functions with local linkage are only unique within their module
+            if (callee->hasLocalLinkage()) {
+                if (auto it = GlobalCtx.ModuleContentHashes.find(callee->getParent()); it != GlobalCtx.ModuleContentHashes.end())
+                    out << "@" << it->second;
+            }
+            out << ",";
+        }
+        out << ";";
+    }
+    return xxHash64(out.str());
+}
+
+ModuleAnalysisCache::ModuleAnalysisCache(StringRef directory, StringRef contentHash) {
+    SmallString<256> filePath(directory);
+    sys::path::append(filePath, contentHash + ".paths");
+    path = filePath.str().str();
+    load();
+}
+
+void ModuleAnalysisCache::load() {
+    auto bufferOrError = MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+    if (!bufferOrError)
+        return;
+
+    BinaryReader reader((*bufferOrError)->getBuffer());
+    StringRef magic;
+    uint32_t version, count;
+    if (!reader.readBytes(sizeof(Magic), magic) || memcmp(magic.data(), Magic, sizeof(Magic)) != 0
+        || !reader.read(version) || version != Version || !reader.read(count))
+        return;
+
+    StringMap<PathAnalysisOutcome> loaded;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t checkCount;
+        StringRef name;
+        PathAnalysisOutcome outcome;
+        if (!reader.readString(name) || !reader.read(outcome.key)
+            || !reader.read(checkCount) || checkCount > (*bufferOrError)->getBufferSize())
+            return;
+        outcome.checks.resize(checkCount);
+        for (auto& check : outcome.checks) {
+            if (!reader.read(check.comparisonIndex) || !reader.read(check.lcs) || !reader.read(check.pathLength)
+                || !reader.read(check.sumOfCondBrCount) || !reader.read(check.errorHandlingBlock))
+                return;
+        }
+        if (!reader.readArray(outcome.inspectedBlocks) || !reader.readArray(outcome.errorBlocks))
+            return;
+        loaded[name] = std::move(outcome);
+    }
+    // A damaged file is ignored as a whole, it gets rewritten by save()
+    if (reader.atEnd())
+        entries = std::move(loaded);
+}
+
+const PathAnalysisOutcome* ModuleAnalysisCache::lookup(StringRef functionName, uint64_t key) const {
+    auto it = entries.find(functionName);
+    if (it == entries.end() || it->second.key != key) {
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    return &it->second;
+}
+
+void ModuleAnalysisCache::store(StringRef functionName, PathAnalysisOutcome&& outcome) {
+    entries[functionName] = std::move(outcome);
+    dirty = true;
+}
+
+void ModuleAnalysisCache::save() const {
+    if (!dirty)
+        return;
+
+    auto tempFile = sys::fs::TempFile::create(path + "-%%%%%%");
+    if (!tempFile) {
+        consumeError(tempFile.takeError());
+        return;
+    }
+    {
+        raw_fd_ostream out(tempFile->FD, /* shouldClose */ false);
+        support::endian::Writer writer(out, support::little);
+        out.write(Magic, sizeof(Magic));
+        writer.write<uint32_t>(Version);
+        writer.write<uint32_t>(entries.size());
+        auto writeIndices = [&](const vector<uint32_t>& indices) {
+            writer.write<uint32_t>(indices.size());
+            for (auto index : indices)
+                writer.write<uint32_t>(index);
+        };
+        for (const auto& entry : entries) {
+            const auto& outcome = entry.second;
+            writer.write<uint32_t>(entry.first().size());
+            out << entry.first();
+            writer.write<uint64_t>(outcome.key);
+            writer.write<uint32_t>(outcome.checks.size());
+            for (const auto& check : outcome.checks) {
+                writer.write<uint32_t>(check.comparisonIndex);
+                writer.write<uint16_t>(check.lcs);
+                writer.write<uint16_t>(check.pathLength);
+                writer.write<uint16_t>(check.sumOfCondBrCount);
+                writer.write<uint32_t>(check.errorHandlingBlock);
+            }
+            writeIndices(outcome.inspectedBlocks);
+            writeIndices(outcome.errorBlocks);
+        }
+    }
+    // Concurrent runs might race on the same entry, the last one wins and both versions are valid
+    if (auto error = tempFile->keep(path))
+        consumeError(std::move(error));
+}
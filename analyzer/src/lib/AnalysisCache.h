@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Function.h>
+
+// Hex SHA1 of the file contents, or an empty string if it cannot be read.
+std::string computeContentHash(llvm::StringRef contents);
+
+/**
+ * Outcome of the path analysis of EHBlockDetectorPass::stage0 for a single function.
+ * Comparisons are identified by their index in the function's potential sanity checks, blocks by their index in the
+ * function, such that an outcome can be restored in a later run that loaded the same bitcode.
+ */
+struct PathAnalysisOutcome {
+    struct Check {
+        uint32_t comparisonIndex;
+        uint16_t lcs, pathLength, sumOfCondBrCount;
+        uint32_t errorHandlingBlock;
+    };
+
+    // Hash of everything outside the function body that the outcome depends on, see pathAnalysisKey
+    uint64_t key = 0;
+    std::vector<Check> checks;
+    // Blocks on at least one inspected path, and the blocks on the chosen error paths
+    std::vector<uint32_t> inspectedBlocks, errorBlocks;
+};
+
+// The path analysis compares the possible targets of calls, so the outcome depends on the callee sets as well.
+uint64_t pathAnalysisKey(const llvm::Function& function);
+
+/**
+ * Cache of path analysis outcomes of one module, stored in the cache directory under the content hash of the bitcode
+ * file the module was loaded from. Modules whose bitcode did not change restore their outcomes, the key of every
+ * entry makes sure functions whose callees changed in other modules are recomputed.
+ * Instances are used by a single thread at a time.
+ */
+class ModuleAnalysisCache {
+public:
+    ModuleAnalysisCache(llvm::StringRef directory, llvm::StringRef contentHash);
+
+    [[nodiscard]] const PathAnalysisOutcome* lookup(llvm::StringRef functionName, uint64_t key) const;
+    void store(llvm::StringRef functionName, PathAnalysisOutcome&& outcome);
+
+    // Writes the cache file if entries were stored, atomically replacing an older version.
+    void save() const;
+
+    static std::atomic<size_t> hits, misses;
+
+private:
+    void load();
+
+    std::string path;
+    llvm::StringMap<PathAnalysisOutcome> entries;
+    bool dirty = false;
+};
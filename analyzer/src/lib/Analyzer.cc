@@ -7,6 +7,7 @@
 
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -14,6 +15,8 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/FileSystem.h"
+#include <llvm/BinaryFormat/Magic.h>
 #include <llvm/Support/ThreadPool.h>
 #include <llvm/Demangle/Demangle.h>
 #include <random>
@@ -24,115 +27,159 @@
 #include "DataFlowAnalysis.h"
 #include "EHBlockDetector.h"
 #include "ErrorCheckViolationFinder.h"
+#include "LazyMaterializer.h"
+#include "AnalysisCache.h"
+#include "ErrorSpecDatabase.h"
+#include "Checkpoint.h"
+#include "MemoryBudget.h"
+#include "ModulePartitioner.h"
+#include "Statistics.h"
+#include "FunctionProfiler.h"
+#include "Trace.h"
+#include "MemoryAccounting.h"
+#include "ReportWriter.h"
 
 // Command line parameters.
 cl::list<string> InputFilenames(
     cl::Positional, cl::OneOrMore, cl::desc("<input bitcode files>"));
 
-cl::opt<unsigned> VerboseLevel(
-    "verbose-level", cl::desc("Print information at which verbose level"),
-    cl::init(0));
+cl::list<string> LazyLoadInputs(
+        "lazy-load",
+        cl::desc("Load input files whose path contains one of these (comma separated) substrings lazily: only function bodies reachable from the other inputs are materialized while loading, e.g. /libc.so.bc. The other bodies are materialized when the analysis first visits their module, the results are the same"),
+        cl::CommaSeparated, cl::NotHidden);
 
-cl::opt<unsigned int> ThreadCount(
-        "c",
-        cl::desc("The amount of threads to use"),
-        cl::NotHidden, cl::init(2));
+cl::opt<string> ExportSpecs(
+        "export-specs",
+        cl::desc("Write the learned error specifications of all non-local functions to this database file"),
+        cl::NotHidden, cl::init(""));
 
-#if 1
-cl::opt<float> AssociationConfidence(
-        "st",
-        cl::desc("Association analysis confidence between [0, 1]. The higher the more confident the association must be."),
-        cl::NotHidden, cl::init(0.925f));
-cl::opt<float> IntervalConfidenceThreshold(
-        "interval-ct",
-        cl::desc("Confidence threshold between [0, 1]. The higher the more similar the error intervals should be."),
-        cl::NotHidden, cl::init(0.5f));
-cl::opt<bool> ShowSafetyChecks(
-        "ssc",
-        cl::desc("Show safety checks."),
+cl::list<string> ImportSpecs(
+        "import-specs",
+        cl::desc("Seed the error specifications of declared functions from these (comma separated) database files, written by --export-specs"),
+        cl::CommaSeparated, cl::NotHidden);
+
+cl::opt<string> CheckpointFile(
+        "checkpoint",
+        cl::desc("Write the call graph and the learned error specifications to this file, such that the bug detection can be re-run with --resume"),
+        cl::NotHidden, cl::init(""));
+
+cl::opt<string> ResumeFile(
+        "resume",
+        cl::desc("Skip the call graph construction and the specification inference, and restore their results from a file written by --checkpoint on the same inputs"),
+        cl::NotHidden, cl::init(""));
+
+cl::opt<bool> ReleaseMemory(
+        "release-memory",
+        cl::desc("Release function bodies and intermediate analysis state as soon as no later stage reads them, to lower the peak memory usage"),
         cl::NotHidden, cl::init(false));
-cl::opt<unsigned int> PrintRandomNonVoidFunctionSamples(
-        "print-random-non-void-function-samples",
-        cl::desc("How many random non-void function names to print, useful for sampling functions to compute a recall"),
+
+cl::opt<unsigned int> SplitModuleCount(
+        "split-module",
+        cl::desc("Split every eagerly loaded input into up to this many partitions, such that a single combined input is analyzed in parallel"),
         cl::NotHidden, cl::init(0));
-cl::opt<bool> RefineWithVSA(
-        "refine-vsa",
-        cl::desc("Refine error intervals using VSA."),
-        cl::NotHidden, cl::init(true));
-cl::opt<float> IncorrectCheckThreshold(
-        "incorrect-ct",
-        cl::desc("Incorrect check threshold between [0, 1]."),
-        cl::NotHidden, cl::init(0.725f));
-cl::opt<float> MissingCheckThreshold(
-        "missing-ct",
-        cl::desc("Missing check threshold between [0, 1]."),
-        cl::NotHidden, cl::init(0.725f));
-#endif
-cl::opt<MLTAMode> MLTA(
-        "mlta-mode",
-        cl::desc("Sets in which mode MLTA runs"),
-        cl::values(
-                clEnumVal(NoIndirectCalls, "No indirect call analysis"),
-                clEnumVal(MatchSignatures, "Consider all matching type signatures as possible call targets"),
-                clEnumVal(FullMLTA, "Full MLTA implementation")
-        ),
-        cl::NotHidden, cl::init(FullMLTA)
-);
-
-cl::opt<string> FunctionTestCasesToAnalyze(
-        "function-test-cases-to-analyzer",
-        cl::desc("An allowlist (comma separated) that specifies which functions to run through the analyzer as a means of testing."),
+
+cl::opt<unsigned int> MaxMemory(
+        "max-memory",
+        cl::desc("Memory budget in MiB for loading the inputs: a module is only parsed once its estimated in-memory size fits next to the loaded modules, 0 for no limit"),
+        cl::NotHidden, cl::init(0));
+
+cl::opt<string> StatsJSONFile(
+        "stats-json-file",
+        cl::desc("Write the wall time, CPU time and resident memory change of every analysis phase, and the analysis counters as JSON to this file"),
         cl::NotHidden, cl::init(""));
 
-GlobalContext GlobalCtx;
+cl::opt<unsigned int> ProfileFunctions(
+        "profile-functions",
+        cl::desc("Profile the analysis time and work per function, and print this many of the most expensive functions at exit"),
+        cl::NotHidden, cl::init(0));
 
+cl::opt<string> TraceFile(
+        "trace",
+        cl::desc("Write Chrome trace events (chrome://tracing, Perfetto) of the module loads, the module pass tasks and the analysis phases to this file"),
+        cl::NotHidden, cl::init(""));
 
-void IterativeModulePass::run(const std::vector<llvm::Module *> &modules, bool multithreaded) {
-  OP << "[" << ID << "] Initializing " << modules.size() << " modules ";
-  bool again = true;
-  while (again) {
-    again = false;
-    for (auto *module : modules) {
-      again |= doInitialization(module);
-      OP << ".";
-    }
-  }
-  OP << "\n";
+cl::opt<bool> TraceFunctions(
+        "trace-functions",
+        cl::desc("Also trace the analysis of each function with --trace"),
+        cl::NotHidden, cl::init(false));
 
-  {
-    OP << "[" << ID << " / " << 1 << "] ";
+cl::opt<bool> AccountMemory(
+        "account-memory",
+        cl::desc("Print the entry counts and approximate sizes of the analysis data structures and the IR after each phase"),
+        cl::NotHidden, cl::init(false));
 
-    if (multithreaded && ThreadCount > 1) {
-        ThreadPool threadPool(hardware_concurrency(ThreadCount));
-        for (auto *module : modules) {
-            threadPool.async(&IterativeModulePass::_doModulePass, this, module);
-        }
-        threadPool.wait();
-    } else {
-        for (auto *module : modules) {
-            _doModulePass(module);
-        }
-    }
+cl::opt<string> ReportFile(
+        "report-file",
+        cl::desc("Stream the learned error specifications, the safety checks of --ssc and the bug reports as structured records to this file"),
+        cl::NotHidden, cl::init(""));
 
-    //OP << "[" << ID << "] Updated in " << changed << " modules.\n";
-  }
+cl::opt<ReportWriter::Format> ReportFormat(
+        "report-format",
+        cl::desc("Format of --report-file"),
+        cl::values(
+                clEnumValN(ReportWriter::Format::JSONLines, "jsonl", "JSON Lines, one record per line (default)"),
+                clEnumValN(ReportWriter::Format::SARIF, "sarif", "SARIF 2.1.0 log, one result per record")),
+        cl::NotHidden, cl::init(ReportWriter::Format::JSONLines));
 
-  OP << "[" << ID << "] Postprocessing ...\n";
-  again = true;
-  while (again) {
-    again = false;
-    for (auto *m : modules) {
-      again |= doFinalization(m);
-    }
-  }
+static vector<Module*> LazyModules;
 
-  OP << "[" << ID << "] Done!\n\n";
+static bool shouldLoadLazily(StringRef filename) {
+    return any_of(LazyLoadInputs, [&](const string& pattern) {
+        return filename.contains(pattern);
+    });
 }
 
-void loadModule(const char* argv[], unsigned i, mutex* modulesVectorMutex) {
+// Content hashes of the loaded input files, identical inputs are only loaded once
+static StringMap<string> LoadedContentHashes;
+
+// The analysis cache and the checkpoints identify modules by the hash of their contents
+static bool needsContentHashes() {
+    return !CacheDirectory.empty() || !CheckpointFile.empty() || !ResumeFile.empty();
+}
+
+// Rough estimate of the memory needed while parsing the file: the file contents plus the in-memory IR.
+// Parsed bitcode takes up about an order of magnitude more than the file, textual IR about as much as the file.
+// Lazily loaded modules only keep the file contents and the symbol table until they are materialized.
+// Splitting a module briefly holds the module and its partitions.
+static uint64_t estimateLoadFootprint(StringRef filename, bool lazy) {
+    uint64_t fileSize;
+    if (sys::fs::file_size(filename, fileSize))
+        return 0;
+    if (lazy)
+        return 2 * fileSize;
+    uint64_t splitFactor = SplitModuleCount > 1 ? 2 : 1;
+    file_magic magic;
+    if (!identify_magic(filename, magic) && magic == file_magic::bitcode)
+        return splitFactor * 11 * fileSize;
+    return splitFactor * 2 * fileSize;
+}
+
+void loadModule(const char* argv[], unsigned i, mutex* modulesVectorMutex, MemoryBudget* budget) {
+    bool lazy = shouldLoadLazily(InputFilenames[i]);
+    MemoryReservation reservation(*budget, estimateLoadFootprint(InputFilenames[i], lazy));
+    Trace::Span span("load", InputFilenames[i]);
+
+    auto bufferOrError = MemoryBuffer::getFile(InputFilenames[i]);
+    if (!bufferOrError) {
+        OP << argv[0] << ": error loading file '"
+           << InputFilenames[i] << "'\n";
+        return;
+    }
+    string contentHash;
+    if (needsContentHashes()) {
+        contentHash = computeContentHash((*bufferOrError)->getBuffer());
+        lock_guard _(*modulesVectorMutex);
+        auto [it, inserted] = LoadedContentHashes.try_emplace(contentHash, InputFilenames[i]);
+        if (!inserted) {
+            OP << "Skipping " << InputFilenames[i] << ": identical to " << it->second << "\n";
+            return;
+        }
+    }
+
     SMDiagnostic Err;
     auto LLVMCtx = new LLVMContext();
-    unique_ptr<Module> M = parseIRFile(InputFilenames[i], Err, *LLVMCtx);
+    unique_ptr<Module> M = lazy ? getLazyIRModule(std::move(bufferOrError.get()), Err, *LLVMCtx)
+                                : parseIR((*bufferOrError)->getMemBufferRef(), Err, *LLVMCtx);
 
     if (!M) {
         OP << argv[0] << ": error loading file '"
@@ -140,23 +187,259 @@ void loadModule(const char* argv[], unsigned i, mutex* modulesVectorMutex) {
         return;
     }
 
+    // The reservation is held for as long as the modules are resident, that is until the analysis ends
+    reservation.keepResident();
+    if (!lazy && SplitModuleCount > 1) {
+        auto partitions = partitionModule(std::move(M), SplitModuleCount, needsContentHashes());
+        if (ResumeFile.empty()) {
+            for (auto& partition : partitions)
+                CallGraphPass::prepareModule(partition.module.get(), &GlobalCtx);
+        }
+        lock_guard _(*modulesVectorMutex);
+        OP << "Split " << InputFilenames[i] << " into " << partitions.size() << " partition(s)\n";
+        for (auto& partition : partitions) {
+            auto* Module = partition.module.release();
+            GlobalCtx.Modules.push_back(Module);
+            if (!partition.contentHash.empty())
+                GlobalCtx.ModuleContentHashes[Module] = std::move(partition.contentHash);
+        }
+        return;
+    }
+
     Module *Module = M.release();
 #if 0
     OP << "Amount of instructions in " << InputFilenames[i] << ": " << Module->getInstructionCount() << "\n";
 #endif
+    // Index the module for the call graph while the other inputs are still being parsed.
+    // Lazily loaded modules are indexed once their bodies are materialized.
+    if (!lazy && ResumeFile.empty())
+        CallGraphPass::prepareModule(Module, &GlobalCtx);
+
     lock_guard _(*modulesVectorMutex);
     GlobalCtx.Modules.push_back(Module);
+    if (!contentHash.empty())
+        GlobalCtx.ModuleContentHashes[Module] = std::move(contentHash);
+    if (lazy)
+        LazyModules.push_back(Module);
+}
+
+static void materializeLazyModules() {
+    vector<Module*> eagerModules;
+    copy_if(GlobalCtx.Modules.begin(), GlobalCtx.Modules.end(), back_inserter(eagerModules), [](Module* module) {
+        return find(LazyModules, module) == LazyModules.end();
+    });
+    LazyMaterializer materializer(eagerModules, LazyModules);
+    materializer.run();
+    OP << "Lazily loaded " << LazyModules.size() << " module(s): materialized " << materializer.getMaterializedCount()
+       << " function bodies, deferred " << materializer.getDeferredCount() << "\n";
+}
+
+static vector<ErrorSpecDatabase::ErrorSpec> ImportedSpecs;
+
+static bool readImportedSpecs() {
+    for (const auto& path : ImportSpecs) {
+        string error;
+        if (!ErrorSpecDatabase::read(path, ImportedSpecs, error)) {
+            OP << "error importing specifications from '" << path << "': " << error << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// The options that influence the state stored in a checkpoint. The bug detection thresholds are deliberately absent.
+static string checkpointParameters() {
+    string parameters;
+    raw_string_ostream out(parameters);
+    out << "--st=" << AssociationConfidence
+        << " --interval-ct=" << IntervalConfidenceThreshold
+        << " --refine-vsa=" << RefineWithVSA
+        << " --mlta-mode=" << MLTA
+        << " --function-test-cases-to-analyzer=" << FunctionTestCasesToAnalyze
+        << " --lazy-load=" << join(LazyLoadInputs, ",")
+        << " --import-specs=" << join(ImportSpecs, ",") << "\n";
+    return out.str();
+}
+
+// Bodies of inline functions that were unified away are only read while building the call graph:
+// all later stages skip them and callees always resolve to the unified copy.
+static void releaseDuplicateFunctionBodies() {
+    // A copy that was not unified away can still be an indirect call target or be found by name, and the later
+    // stages test whether those have a body
+    DenseSet<const Function*> referenced;
+    for (const auto& [callee, _] : GlobalCtx.Callers)
+        referenced.insert(callee);
+    for (const auto& [_, function] : GlobalCtx.GlobalFuncs)
+        referenced.insert(function);
+
+    unsigned int released = 0;
+    for (auto* module : GlobalCtx.Modules) {
+        for (auto& function : *module) {
+            if (function.empty() || GlobalCtx.UnifiedFuncSet.find(&function) != GlobalCtx.UnifiedFuncSet.end()
+                || referenced.count(&function))
+                continue;
+            // Reports still print the location of direct calls to these, deleteBody() drops the attachment
+            auto subProgram = function.getSubprogram();
+            function.deleteBody();
+            function.setSubprogram(subProgram);
+            ++released;
+        }
+    }
+    CallGraphPass::releaseTypeAnalysis();
+    GlobalCtx.sigFuncsMap.shrink_and_clear();
+    GlobalCtx.FuncPAResults.clear();
+    OP << "Released " << released << " duplicate function bodies\n";
+}
+
+// Once the error intervals are learned and propagated, they, the confidences and the call edges summarize every
+// function for the violation finder. It only reads the bodies of functions with potential sanity checks and of
+// functions that call one with an error interval, which can still propagate to callers while it runs. The other
+// bodies are released before the finder's own state grows.
+static void releaseUnexaminedFunctionBodies() {
+    DenseMap<const Function*, SmallVector<const Function*, 2>> callersOf;
+    for (const auto& [call, callees] : GlobalCtx.Callees) {
+        for (const auto* callee : callees)
+            callersOf[callee].push_back(call->getFunction());
+    }
+    // Functions with an error interval are kept as well, the signedness bugs are determined on their debug info
+    DenseSet<const Function*> examined;
+    vector<const Function*> worklist;
+    for (const auto& [functionKeyPair, _] : GlobalCtx.functionErrorReturnIntervals) {
+        if (examined.insert(functionKeyPair.first).second)
+            worklist.push_back(functionKeyPair.first);
+    }
+    while (!worklist.empty()) {
+        auto it = callersOf.find(worklist.back());
+        worklist.pop_back();
+        if (it == callersOf.end())
+            continue;
+        for (const auto* caller : it->second) {
+            if (examined.insert(caller).second)
+                worklist.push_back(caller);
+        }
+    }
+    for (const auto& [function, _] : GlobalCtx.functionToSanityValuesAndConditions)
+        examined.insert(function);
+
+    DenseSet<const Function*> released;
+    for (auto* module : GlobalCtx.Modules) {
+        for (const auto& function : *module) {
+            if (!function.empty() && !examined.count(&function))
+                released.insert(&function);
+        }
+    }
+
+    // The call edges of the released bodies go away with them
+    for (auto it = GlobalCtx.Callees.begin(), end = GlobalCtx.Callees.end(); it != end; ++it) {
+        if (!released.count(it->first->getFunction()))
+            continue;
+        for (auto* callee : it->second) {
+            if (auto callersIt = GlobalCtx.Callers.find(callee); callersIt != GlobalCtx.Callers.end())
+                callersIt->second.erase(it->first);
+        }
+        GlobalCtx.Callees.erase(it);
+    }
+
+    for (auto* module : GlobalCtx.Modules) {
+        for (auto& function : *module) {
+            if (!released.count(&function))
+                continue;
+            // Reports still print the location of direct calls to these, deleteBody() drops the attachment
+            auto subProgram = function.getSubprogram();
+            function.deleteBody();
+            function.setSubprogram(subProgram);
+        }
+    }
+    OP << "Released " << released.size() << " function bodies that the violation finder does not examine\n";
+}
+
+// Alias analysis and the potential sanity checks are last used while finding incorrect checks.
+static void releaseCheckAnalysis() {
+    for (const auto& [function, pairs] : GlobalCtx.functionToSanityValuesAndConditions) {
+        for (const auto& [_, abstractComparison] : pairs) {
+            delete abstractComparison;
+        }
+    }
+    GlobalCtx.functionToSanityValuesAndConditions.clear();
+    for (const auto& [function, aa] : GlobalCtx.AAPass) {
+        delete aa;
+    }
+    GlobalCtx.AAPass.clear();
+}
+
+// Prints the sizes of the global analysis state and of the given passes' state, with --account-memory.
+static void reportMemory(StringRef phase, const EHBlockDetectorPass* ehPass = nullptr, const ErrorCheckViolationFinderPass* ecvfPass = nullptr) {
+    if (!AccountMemory)
+        return;
+    using namespace MemoryAccounting;
+    MemoryReport report(phase);
+
+    size_t irBytes = 0;
+    for (const auto* module : GlobalCtx.Modules)
+        irBytes += approximateIRBytes(*module);
+    report.add("LLVM IR (functions, blocks, instructions)", GlobalCtx.Modules.size(), irBytes);
+
+    report.add("GlobalFuncs", GlobalCtx.GlobalFuncs);
+    report.add("Callees", GlobalCtx.Callees);
+    report.add("Callers", GlobalCtx.Callers);
+    report.add("UnifiedFuncMap", GlobalCtx.UnifiedFuncMap);
+    report.add("UnifiedFuncSet", GlobalCtx.UnifiedFuncSet);
+    report.add("sigFuncsMap", GlobalCtx.sigFuncsMap);
+    report.add("FuncPAResults", GlobalCtx.FuncPAResults);
+    report.add("AAPass", GlobalCtx.AAPass.size(),
+               approximateBytes(GlobalCtx.AAPass) + GlobalCtx.AAPass.size() * sizeof(AAResultsWrapperPass));
+    size_t conditions = 0;
+    for (const auto& [function, pairs] : GlobalCtx.functionToSanityValuesAndConditions)
+        conditions += pairs.size();
+    report.add("functionToSanityValuesAndConditions", GlobalCtx.functionToSanityValuesAndConditions.size(),
+               approximateBytes(GlobalCtx.functionToSanityValuesAndConditions) + conditions * sizeof(AbstractComparison));
+    report.add("functionErrorReturnIntervals", GlobalCtx.functionErrorReturnIntervals.size(),
+               sizeof(FunctionErrorReturnIntervals) + GlobalCtx.functionErrorReturnIntervals.approximateHeapBytes());
+    report.add("calleeIntervalCache", GlobalCtx.calleeIntervalCache.size(),
+               sizeof(CalleeIntervalCache) + GlobalCtx.calleeIntervalCache.approximateHeapBytes());
+    report.add("functionToConfidence", GlobalCtx.functionToConfidence);
+    report.add("IntervalPool", IntervalPool::get().size(), IntervalPool::get().size() * sizeof(InternedInterval));
+
+    if (ehPass)
+        ehPass->accountMemory(report);
+    if (ecvfPass)
+        ecvfPass->accountMemory(report);
+    report.print(OP);
 }
 
 int main(int argc, const char* argv[]) {
 	// Print a stack trace if we signal out.
 	sys::PrintStackTraceOnErrorSignal(argv[0]);
+	// Write out the log of the crashing thread before the stack trace
+	sys::AddSignalHandler([](void*) { Log::flushOnCrash(); }, nullptr);
 	PrettyStackTraceProgram X(argc, argv);
 
 	llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
 
 	cl::ParseCommandLineOptions(argc, argv, "global analysis\n");
 
+	if (ProfileFunctions > 0)
+		FunctionProfiler::enable();
+	if (TimePassesIsEnabled || !StatsJSONFile.empty())
+		Statistics::enable();
+	if (!TraceFile.empty())
+		Trace::enable(TraceFunctions);
+	if (!ReportFile.empty()) {
+		string error;
+		if (!ReportWriter::open(ReportFile, ReportFormat, error)) {
+			OP << "Cannot write " << ReportFile << ": " << error << "\n";
+			return 1;
+		}
+	}
+	if (!readImportedSpecs())
+		return 1;
+	if (!CacheDirectory.empty()) {
+		if (auto error = sys::fs::create_directories(CacheDirectory)) {
+			OP << "Cannot create " << CacheDirectory << ": " << error.message() << "\n";
+			return 1;
+		}
+	}
+
 	// Loading modules
 	OP << "Total " << InputFilenames.size() << " file(s)\n";
 
@@ -164,11 +447,26 @@ int main(int argc, const char* argv[]) {
     OP << "MissingCheckThreshold = " << format("%.2f", MissingCheckThreshold * 100.0f) << "\n";
 
     mutex modulesVectorMutex;
-    ThreadPool loadPool;
-	for (unsigned i = 0; i < InputFilenames.size(); ++i) {
-        loadPool.async(&loadModule, argv, i, &modulesVectorMutex);
-	}
-    loadPool.wait();
+    MemoryBudget loadBudget(static_cast<uint64_t>(MaxMemory) * 1024 * 1024);
+    {
+        PhaseTimer phase("loading");
+        Log::flush();
+        // At most -c inputs are parsed at once, and only as many as fit into the --max-memory budget next to the
+        // loaded ones: the loading jobs wait for their reservation on the pool's threads
+        ThreadPool loadPool(hardware_concurrency(ThreadCount));
+        for (unsigned i = 0; i < InputFilenames.size(); ++i) {
+            loadPool.async([&, i]() {
+                loadModule(argv, i, &modulesVectorMutex, &loadBudget);
+                Log::flush();
+            });
+        }
+        loadPool.wait();
+        if (MaxMemory > 0)
+            loadBudget.printStatistics(OP);
+        if (!LazyModules.empty())
+            materializeLazyModules();
+    }
+    reportMemory("loading");
 
     if (PrintRandomNonVoidFunctionSamples > 0) {
         set<const Function*> functionsToSampleFrom;
@@ -178,7 +476,7 @@ int main(int argc, const char* argv[]) {
                 continue;
 #endif
             for (const auto& F : *module) {
-                if (F.empty())
+                if (F.isDeclaration())
                     continue;
                 if (F.getReturnType()->isVoidTy())
                     continue;
@@ -206,47 +504,167 @@ int main(int argc, const char* argv[]) {
         if (module->getName().contains("/libc.so.bc"))
             continue;
 #endif
-        totalCount += count_if(*module, [](const auto& function) { return !function.empty(); });
-        totalCountNonVoid += count_if(*module, [](const auto& function) { return !function.empty() && !function.getReturnType()->isVoidTy(); });
+        // Bodies of lazily loaded modules that are not materialized yet count as well
+        totalCount += count_if(*module, [](const auto& function) { return !function.isDeclaration(); });
+        totalCountNonVoid += count_if(*module, [](const auto& function) { return !function.isDeclaration() && !function.getReturnType()->isVoidTy(); });
     }
     OP << "Total number of functions: " << totalCount << "\n";
     OP << "Total number of non-void functions: " << totalCountNonVoid << "\n";
 #endif
 
-    {
-        CallGraphPass CGPass(&GlobalCtx);
-        CGPass.run(GlobalCtx.Modules);
-    }
+    if (!ResumeFile.empty()) {
+        PhaseTimer phase("resume");
+        string error;
+        vector<const Function*> recomputeSanityChecks;
+        // The checkpoint refers to the functions by their bodies, this is the first visit of the lazily loaded ones
+        for (auto* module : LazyModules)
+            LazyMaterializer::materializeOnFirstVisit(module);
+        if (!Checkpoint::read(ResumeFile, GlobalCtx, checkpointParameters(), recomputeSanityChecks, error)) {
+            OP << "error resuming from '" << ResumeFile << "': " << error << "\n";
+            return 1;
+        }
+        OP << "Resumed from " << ResumeFile << "\n";
+        if (ReleaseMemory)
+            releaseDuplicateFunctionBodies();
+        // The alias analysis results are recomputed rather than stored, as are the checks the checkpoint could not hold
+        EHBlockDetectorPass EHPass(&GlobalCtx);
+        for (auto* module : GlobalCtx.Modules)
+            EHPass.initializeAliasAnalysis(module);
+        for (const auto* function : recomputeSanityChecks)
+            EHPass.collectPotentialSanityChecks(*function);
+        reportMemory("resume", &EHPass);
+    } else {
+        {
+            PhaseTimer phase("CallGraphPass");
+            CallGraphPass CGPass(&GlobalCtx);
+            CGPass.run(GlobalCtx.Modules);
+        }
+        if (ReleaseMemory)
+            releaseDuplicateFunctionBodies();
+        reportMemory("CallGraphPass");
 
-    {
         EHBlockDetectorPass EHPass(&GlobalCtx);
-        EHPass.run(GlobalCtx.Modules, true);
+        {
+            PhaseTimer phase("EHBlockDetectorPass stage 0");
+            EHPass.run(GlobalCtx.Modules, true);
+        }
+        reportMemory("EHBlockDetectorPass stage 0", &EHPass);
+        if (!CacheDirectory.empty())
+            OP << "Path analysis cache: " << ModuleAnalysisCache::hits << " hits, " << ModuleAnalysisCache::misses << " misses\n";
         EHPass.nextStage();
-        EHPass.associationAnalysisForErrorHandlers();
-        EHPass.run(GlobalCtx.Modules, true);
-        EHPass.storeData();
-        EHPass.learnErrorsFromErrorBlocksForSelf();
-        EHPass.propagateCheckedErrors();
+        {
+            PhaseTimer phase("associationAnalysisForErrorHandlers");
+            EHPass.associationAnalysisForErrorHandlers();
+        }
+        reportMemory("associationAnalysisForErrorHandlers", &EHPass);
+        {
+            PhaseTimer phase("EHBlockDetectorPass stage 1");
+            EHPass.run(GlobalCtx.Modules, true);
+        }
+        reportMemory("EHBlockDetectorPass stage 1", &EHPass);
+        {
+            PhaseTimer phase("storeData");
+            EHPass.storeData();
+        }
+        reportMemory("storeData", &EHPass);
+        if (!ImportedSpecs.empty()) {
+            // Imported specifications take precedence over those inferred from the checks in this program
+            OP << "Imported " << ErrorSpecDatabase::seed(ImportedSpecs, GlobalCtx) << " of " << ImportedSpecs.size() << " error specifications\n";
+        }
+        {
+            PhaseTimer phase("learnErrorsFromErrorBlocksForSelf");
+            EHPass.learnErrorsFromErrorBlocksForSelf();
+        }
+        {
+            PhaseTimer phase("propagateCheckedErrors");
+            EHPass.propagateCheckedErrors();
+        }
+        reportMemory("propagation", &EHPass);
+
+        if (!CheckpointFile.empty()) {
+            string error;
+            if (!Checkpoint::write(CheckpointFile, GlobalCtx, checkpointParameters(), error)) {
+                OP << "error writing checkpoint to '" << CheckpointFile << "': " << error << "\n";
+                return 1;
+            }
+        }
+    }
+
+    if (ReleaseMemory) {
+        {
+            PhaseTimer phase("releaseUnexaminedFunctionBodies");
+            releaseUnexaminedFunctionBodies();
+        }
+        reportMemory("releaseUnexaminedFunctionBodies");
     }
 
     {
         ErrorCheckViolationFinderPass ECVFPass(&GlobalCtx);
-        ECVFPass.run(GlobalCtx.Modules);
+        {
+            PhaseTimer phase("ErrorCheckViolationFinderPass stage 0");
+            ECVFPass.run(GlobalCtx.Modules);
+        }
+        reportMemory("ErrorCheckViolationFinderPass stage 0", nullptr, &ECVFPass);
         ECVFPass.nextStage();
-        ECVFPass.run(GlobalCtx.Modules);
-        ECVFPass.determineTruncationBugs();
-        ECVFPass.determineSignednessBugs();
-        ECVFPass.finish();
+        {
+            PhaseTimer phase("ErrorCheckViolationFinderPass stage 1");
+            ECVFPass.run(GlobalCtx.Modules);
+        }
+        if (ReleaseMemory)
+            releaseCheckAnalysis();
+        reportMemory("ErrorCheckViolationFinderPass stage 1", nullptr, &ECVFPass);
+        {
+            PhaseTimer phase("determineTruncationBugs");
+            ECVFPass.determineTruncationBugs();
+        }
+        {
+            PhaseTimer phase("determineSignednessBugs");
+            ECVFPass.determineSignednessBugs();
+        }
+        reportMemory("determineTruncationBugs and determineSignednessBugs", nullptr, &ECVFPass);
+        {
+            PhaseTimer phase("report");
+            ECVFPass.finish();
+        }
+    }
+
+    if (!ExportSpecs.empty()) {
+        string error;
+        if (!ErrorSpecDatabase::exportTo(ExportSpecs, GlobalCtx, error)) {
+            OP << "error exporting specifications to '" << ExportSpecs << "': " << error << "\n";
+            return 1;
+        }
+    }
+
+    if (!ReportFile.empty()) {
+        string error;
+        if (!ReportWriter::close(error)) {
+            OP << "error writing reports to '" << ReportFile << "': " << error << "\n";
+            return 1;
+        }
     }
 
     // Cleanup memory to keep ASAN etc. happy
-    for (const auto& [function, pairs] : GlobalCtx.functionToSanityValuesAndConditions) {
-        for (const auto& [_, abstractComparison] : pairs) {
-            delete abstractComparison;
+    releaseCheckAnalysis();
+
+    if (ProfileFunctions > 0)
+        FunctionProfiler::print(OP, ProfileFunctions);
+    // LLVM's own --time-passes
+    if (TimePassesIsEnabled)
+        Statistics::print(OP);
+    if (!TraceFile.empty()) {
+        string error;
+        if (!Trace::write(TraceFile, error)) {
+            OP << "error writing trace to '" << TraceFile << "': " << error << "\n";
+            return 1;
         }
     }
-    for (const auto& [function, aa] : GlobalCtx.AAPass) {
-        delete aa;
+    if (!StatsJSONFile.empty()) {
+        string error;
+        if (!Statistics::writeJSON(StatsJSONFile, error)) {
+            OP << "error writing statistics to '" << StatsJSONFile << "': " << error << "\n";
+            return 1;
+        }
     }
 
 	return 0;
@@ -23,6 +23,9 @@
 
 #include "Common.h"
 #include "FunctionErrorReturnIntervals.h"
+#include "CalleeIntervalCache.h"
+#include "IntervalPool.h"
+#include "Trace.h"
 
 
 using CallInstSetEntry = llvm::CallInst*;
@@ -46,7 +49,7 @@ struct InErrorNotInErrorPair {
     unsigned int inError {}, notInError {};
 };
 
-using IntervalHashMap = unordered_map<Interval, unsigned int, IntervalHash>;
+using IntervalHashMap = unordered_map<IntervalRef, unsigned int, IntervalRefHash>;
 using FunctionToIntervalCounts = DenseMap<pair<const Function*, unsigned int>, IntervalHashMap>;
 
 struct GlobalContext {
@@ -68,6 +71,9 @@ struct GlobalContext {
 
 	std::vector<llvm::Module *> Modules;
 
+	// Content hash of the bitcode file each module was loaded from
+	DenseMap<const Module*, string> ModuleContentHashes;
+
 	// Pointer analysis results.
     FuncPointerAnalysisMap FuncPAResults;
 
@@ -78,6 +84,7 @@ struct GlobalContext {
     // Error handling rules
 	map<const Function*, vector<pair<pair<const Value*, unsigned int>, const class AbstractCondition*>>> functionToSanityValuesAndConditions;
 	FunctionErrorReturnIntervals functionErrorReturnIntervals;
+	CalleeIntervalCache calleeIntervalCache{functionErrorReturnIntervals};
 	mutex functionToConfidenceMutex;
 	map<pair<const Function*, unsigned int>, float> functionToConfidence;
 
@@ -103,6 +110,10 @@ public:
 	virtual bool doInitialization(llvm::Module *M)
 		{ return true; }
 
+	// Whether doInitialization can run concurrently for distinct modules. It then runs once per module.
+	[[nodiscard]] virtual bool initializesConcurrently() const
+		{ return false; }
+
 	// Run on each module after iterative pass.
 	virtual bool doFinalization(llvm::Module *M)
 		{ return true; }
@@ -116,6 +127,7 @@ public:
 private:
     void _doModulePass(llvm::Module* M) {
         //OP << M->getName() << "\n";
+        Trace::Span span(ID, M->getModuleIdentifier());
         doModulePass(M);
     }
 };
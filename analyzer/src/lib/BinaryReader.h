@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Endian.h>
+
+// Bounds-checked reader of the little endian files written with support::endian::Writer.
+// Every read returns false, leaving the output unspecified, once the data is exhausted.
+class BinaryReader {
+public:
+    explicit BinaryReader(llvm::StringRef data) : data(data) {}
+
+    template<typename T>
+    bool read(T& value) {
+        if (data.size() < sizeof(T))
+            return false;
+        value = llvm::support::endian::read<T, llvm::support::little, llvm::support::unaligned>(data.data());
+        data = data.drop_front(sizeof(T));
+        return true;
+    }
+
+    bool readBytes(size_t count, llvm::StringRef& bytes) {
+        if (data.size() < count)
+            return false;
+        bytes = data.take_front(count);
+        data = data.drop_front(count);
+        return true;
+    }
+
+    // u32 length, followed by the bytes
+    bool readString(llvm::StringRef& string) {
+        uint32_t length;
+        return read(length) && readBytes(length, string);
+    }
+
+    // u32 count, followed by the elements
+    template<typename T>
+    bool readArray(std::vector<T>& out) {
+        uint32_t count;
+        if (!read(count) || count > data.size() / sizeof(T))
+            return false;
+        out.resize(count);
+        for (auto& element : out)
+            read(element);
+        return true;
+    }
+
+    [[nodiscard]] bool atEnd() const { return data.empty(); }
+
+private:
+    llvm::StringRef data;
+};
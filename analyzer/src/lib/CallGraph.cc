@@ -35,6 +35,7 @@
 #include "Common.h"
 #include "Helpers.h"
 #include "ClOptForward.h"
+#include "LazyMaterializer.h"
 
 //#define UNROLL_LOOP_ONCE
 #define CONSERVATIVE_PTR_TYPES
@@ -43,7 +44,8 @@ DenseMap<size_t, FuncSet> CallGraphPass::typeFuncsMap;
 unordered_map<size_t, unordered_set<size_t>> CallGraphPass::typeConfineMap;
 unordered_map<size_t, unordered_set<size_t>> CallGraphPass::typeTransitMap;
 unordered_set<size_t> CallGraphPass::typeEscapeSet;
-const DataLayout *CurrentLayout;
+// Per thread, such that modules can be indexed concurrently
+thread_local const DataLayout *CurrentLayout;
 
 // Find targets of indirect calls based on type analysis: as long as
 // the number and type of parameters of a function matches with the
@@ -248,7 +250,7 @@ bool CallGraphPass::typeConfineInInitializer(User* Ini) {
 				Type *ITy = U->getType();
 				// TODO: use offset?
 				unsigned ONo = oi->getOperandNo();
-				typeFuncsMap[typeIdxHash(ITy, ONo)].insert(F);
+				index->typeFuncsMap[typeIdxHash(ITy, ONo)].insert(F);
 			}
 			// Case 2: a composite-type object (value) is assigned to a
 			// field of another composite-type object
@@ -256,7 +258,7 @@ bool CallGraphPass::typeConfineInInitializer(User* Ini) {
 				// confine composite types
 				Type *ITy = U->getType();
 				unsigned ONo = oi->getOperandNo();
-				typeConfineMap[typeIdxHash(ITy, ONo)].insert(typeHash(OTy));
+				index->typeConfineMap[typeIdxHash(ITy, ONo)].insert(typeHash(OTy));
 
 				// recognize nested composite types
 				LU.emplace(dyn_cast<User>(O));
@@ -294,7 +296,7 @@ bool CallGraphPass::typeConfineInStore(StoreInst *SI) {
 		Type *STy;
 		int Idx;
 		if (nextLayerBaseType(PO, STy, Idx, DL)) {
-			typeFuncsMap[typeIdxHash(STy, Idx)].insert(F);
+			index->typeFuncsMap[typeIdxHash(STy, Idx)].insert(F);
 			return true;
 		}
 		else {
@@ -310,7 +312,7 @@ bool CallGraphPass::typeConfineInStore(StoreInst *SI) {
 	Type *VTy = VO->getType();
 	if (isCompositeType(VTy)) {
 		if (isCompositeType(EPTy)) {
-			typeConfineMap[typeHash(EPTy)].insert(typeHash(VTy));
+			index->typeConfineMap[typeHash(EPTy)].insert(typeHash(VTy));
 			return true;
 		}
 		else {
@@ -336,7 +338,7 @@ bool CallGraphPass::typeConfineInStore(StoreInst *SI) {
 	if (nextLayerBaseType(PO, STy, Idx, DL)) {
 		// The value operand is a pointer to a composite-type object
 		if (isCompositeType(EVTy)) {
-			typeConfineMap[typeIdxHash(STy,
+			index->typeConfineMap[typeIdxHash(STy,
 					Idx)].insert(typeHash(EVTy)); 
 			return true;
         }
@@ -351,12 +353,13 @@ bool CallGraphPass::typeConfineInStore(StoreInst *SI) {
             } else {
                 // No indirect calls to this function. As we have all the direct callers already we can check
                 // if all arguments are statically known.
-                for (const auto *caller: Ctx->Callers[containingFunction]) {
+                auto callersIt = Ctx->Callers.find(containingFunction);
+                for (const auto *caller: callersIt == Ctx->Callers.end() ? CallInstSet {} : callersIt->second) {
                     auto callerArgumentValue = caller->getArgOperand(argumentValue->getArgNo());
                     if (auto calledFunction = dyn_cast<Function>(callerArgumentValue)) {
-                        typeFuncsMap[typeIdxHash(STy, Idx)].insert(calledFunction);
+                        index->typeFuncsMap[typeIdxHash(STy, Idx)].insert(calledFunction);
                     } else {
-                        typeFuncsMap[typeIdxHash(STy, Idx)].clear();
+                        index->typeFuncsMap[typeIdxHash(STy, Idx)].clear();
                         escapeType(STy, SI, Idx);
                         break;
                     }
@@ -372,7 +375,7 @@ bool CallGraphPass::typeConfineInStore(StoreInst *SI) {
             set<const Value*> visited;
             if (collectFunctions(VO, functions, visited)) {
                 for (const auto* F : functions)
-                    typeFuncsMap[typeIdxHash(STy, Idx)].insert(const_cast<Function*>(F));
+                    index->typeFuncsMap[typeIdxHash(STy, Idx)].insert(const_cast<Function*>(F));
             } else {
                 escapeType(STy, SI, Idx);
             }
@@ -409,18 +412,18 @@ bool CallGraphPass::typeConfineInCast(CastInst *CastI) {
 
 void CallGraphPass::escapeType(Type *Ty, const StoreInst* SI, int Idx) {
 	if (Idx == -1)
-		typeEscapeSet.insert(typeHash(Ty));
+		index->typeEscapeSet.insert(typeHash(Ty));
 	else
-		typeEscapeSet.insert(typeIdxHash(Ty, Idx));
+		index->typeEscapeSet.insert(typeIdxHash(Ty, Idx));
 }
 
 void CallGraphPass::transitType(Type *ToTy, Type *FromTy,
 		int ToIdx, int FromIdx) {
 	if (ToIdx != -1 && FromIdx != -1)
-		typeTransitMap[typeIdxHash(ToTy, 
-				ToIdx)].insert(typeIdxHash(FromTy, FromIdx));
+		index->typeTransitions.emplace_back(typeIdxHash(ToTy, ToIdx),
+				typeIdxHash(FromTy, FromIdx));
 	else
-		typeTransitMap[typeHash(ToTy)].insert(typeHash(FromTy));
+		index->typeTransitions.emplace_back(typeHash(ToTy), typeHash(FromTy));
 }
 
 void CallGraphPass::funcSetIntersection(FuncSet &FS1, FuncSet &FS2, 
@@ -614,11 +617,17 @@ bool CallGraphPass::collectFunctions(const Value* value, SmallPtrSet<const Funct
     return false;
 }
 
-bool CallGraphPass::doInitialization(Module *M) {
+static mutex preparedIndicesMutex;
+static DenseMap<const Module*, unique_ptr<CallGraphModuleIndex>> preparedIndices;
+
+unique_ptr<CallGraphModuleIndex> CallGraphPass::indexModule(Module *M, GlobalContext *Ctx) {
+    auto result = make_unique<CallGraphModuleIndex>();
+    CallGraphPass indexer(Ctx);
+    indexer.index = result.get();
     CurrentLayout = &M->getDataLayout();
-	DL = &M->getDataLayout();
-	Int8PtrTy = Type::getInt8PtrTy(M->getContext());
-	IntPtrTy = DL->getIntPtrType(M->getContext());
+    indexer.DL = &M->getDataLayout();
+    indexer.Int8PtrTy = Type::getInt8PtrTy(M->getContext());
+    indexer.IntPtrTy = indexer.DL->getIntPtrType(M->getContext());
 
 	//
 	// Iterate and process globals
@@ -629,49 +638,18 @@ bool CallGraphPass::doInitialization(Module *M) {
 		if (!GV->hasInitializer())
 			continue;
 		Constant *Ini = GV->getInitializer();
-		typeConfineInInitializer(Ini);
+		indexer.typeConfineInInitializer(Ini);
 	}
 
     for (auto& alias : M->aliases()) {
-        if (auto function = dyn_cast<Function>(alias.getAliasee())) {
-            // Link
-            size_t fh = funcHash(function, alias.getName());
-            if (Ctx->UnifiedFuncMap.find(fh) == Ctx->UnifiedFuncMap.end()) {
-                Ctx->UnifiedFuncMap[fh] = function;
-                Ctx->UnifiedFuncSet.insert(function);
-            }
-            Ctx->GlobalFuncs[alias.getName()] = function;
-        }
+        if (auto function = dyn_cast<Function>(alias.getAliasee()))
+            result->aliases.push_back({function, alias.getName(), funcHash(function, alias.getName())});
     }
 
     for (Function &F : *M) {
         if (F.isDeclaration())
             continue;
-
-        // Collect global function definitions.
-        if (F.hasExternalLinkage() && !F.empty()) {
-            // External linkage always ends up with the function name.
-            StringRef FName = F.getName();
-
-            // Map functions to their names.
-            Ctx->GlobalFuncs[FName] = &F;
-        }
-
-        // Keep a single copy for same functions (inline functions)
-        size_t fh = funcHash(&F);
-        if (Ctx->UnifiedFuncMap.find(fh) == Ctx->UnifiedFuncMap.end()) {
-            Ctx->UnifiedFuncMap[fh] = &F;
-            Ctx->UnifiedFuncSet.insert(&F);
-        }
-
-        // Collect address-taken functions.
-        if (couldPotentiallyBeUsedAsAnIndirectCallTarget(F)) {
-            //LOG(LOG_INFO, "Address-taken function that may be an indirect call target: " << F.getName() << "\n");
-
-            auto func = Ctx->UnifiedFuncMap[fh];
-            AddressTakenFuncs.insert(func);
-            Ctx->sigFuncsMap[funcHash(func, false)].insert(func);
-        }
+        result->definitions.push_back({&F, funcHash(&F), couldPotentiallyBeUsedAsAnIndirectCallTarget(F)});
     }
 
 	// Iterate functions and instructions for indirect cases
@@ -682,9 +660,9 @@ bool CallGraphPass::doInitialization(Module *M) {
 
             for (auto &instruction: instructions(F)) {
                 if (auto SI = dyn_cast<StoreInst>(&instruction)) {
-                    typeConfineInStore(SI);
+                    indexer.typeConfineInStore(SI);
                 } else if (auto CastI = dyn_cast<CastInst>(&instruction)) {
-                    typeConfineInCast(CastI);
+                    indexer.typeConfineInCast(CastI);
                 }
             }
         }
@@ -704,12 +682,88 @@ bool CallGraphPass::doInitialization(Module *M) {
             SmallVector<pair<unsigned, MDNode*>, 4> mds;
             instruction.getAllMetadata(mds);
             for (const auto& entry : mds) {
-                visitMetadata(entry.second);
+                indexer.visitMetadata(entry.second);
             }
         }
     }
 
-    metadata.clear();
+    return result;
+}
+
+void CallGraphPass::prepareModule(Module *M, GlobalContext *Ctx) {
+    auto index = indexModule(M, Ctx);
+    lock_guard _(preparedIndicesMutex);
+    preparedIndices[M] = std::move(index);
+}
+
+bool CallGraphPass::doInitialization(Module *M) {
+    unique_ptr<CallGraphModuleIndex> moduleIndex;
+    {
+        lock_guard _(preparedIndicesMutex);
+        if (auto it = preparedIndices.find(M); it != preparedIndices.end()) {
+            moduleIndex = std::move(it->second);
+            preparedIndices.erase(it);
+        }
+    }
+    if (!moduleIndex) {
+        // Lazily loaded modules are not prepared while loading, this is the first pass to visit their bodies
+        LazyMaterializer::materializeOnFirstVisit(M);
+        moduleIndex = indexModule(M, Ctx);
+    }
+
+    CurrentLayout = &M->getDataLayout();
+	DL = &M->getDataLayout();
+	Int8PtrTy = Type::getInt8PtrTy(M->getContext());
+	IntPtrTy = DL->getIntPtrType(M->getContext());
+
+    // Merge the index, the order of the modules decides which copy of a function is kept
+    for (const auto& alias : moduleIndex->aliases) {
+        // Link
+        if (Ctx->UnifiedFuncMap.find(alias.hash) == Ctx->UnifiedFuncMap.end()) {
+            Ctx->UnifiedFuncMap[alias.hash] = alias.function;
+            Ctx->UnifiedFuncSet.insert(alias.function);
+        }
+        Ctx->GlobalFuncs[alias.name] = alias.function;
+    }
+
+    for (const auto& definition : moduleIndex->definitions) {
+        auto& F = *definition.function;
+
+        // Collect global function definitions.
+        if (F.hasExternalLinkage() && !F.empty()) {
+            // External linkage always ends up with the function name.
+            StringRef FName = F.getName();
+
+            // Map functions to their names.
+            Ctx->GlobalFuncs[FName] = &F;
+        }
+
+        // Keep a single copy for same functions (inline functions)
+        size_t fh = definition.hash;
+        if (Ctx->UnifiedFuncMap.find(fh) == Ctx->UnifiedFuncMap.end()) {
+            Ctx->UnifiedFuncMap[fh] = &F;
+            Ctx->UnifiedFuncSet.insert(&F);
+        }
+
+        // Collect address-taken functions.
+        if (definition.addressTaken) {
+            //LOG(LOG_INFO, "Address-taken function that may be an indirect call target: " << F.getName() << "\n");
+
+            auto func = Ctx->UnifiedFuncMap[fh];
+            AddressTakenFuncs.insert(func);
+            Ctx->sigFuncsMap[funcHash(func, false)].insert(func);
+        }
+    }
+
+    for (const auto& [hash, functions] : moduleIndex->typeFuncsMap)
+        typeFuncsMap[hash].insert(functions.begin(), functions.end());
+    for (const auto& [hash, hashes] : moduleIndex->typeConfineMap)
+        typeConfineMap[hash].insert(hashes.begin(), hashes.end());
+    for (const auto& [toHash, fromHash] : moduleIndex->typeTransitions)
+        typeTransitMap[toHash].insert(fromHash);
+    typeEscapeSet.insert(moduleIndex->typeEscapeSet.begin(), moduleIndex->typeEscapeSet.end());
+    for (auto& [key, debugTag] : moduleIndex->typeAndOffsetToDebugTags)
+        typeAndOffsetToDebugTags[key] = std::move(debugTag);
 #if 0
     for (const auto& [a, b] : typeAndOffsetToDebugTags) {
         LOG(LOG_INFO, a.first << "[" << a.second << "] -> " << b << "\n");
@@ -723,6 +777,13 @@ bool CallGraphPass::doFinalization(Module *M) {
 	return false;
 }
 
+void CallGraphPass::releaseTypeAnalysis() {
+    typeFuncsMap.shrink_and_clear();
+    typeConfineMap = {};
+    typeTransitMap = {};
+    typeEscapeSet = {};
+}
+
 string CallGraphPass::computeDebugTag(const DISubroutineType* subroutineType) {
     // TODO: some caching?
     string differentiation;
@@ -758,7 +819,7 @@ void CallGraphPass::visitMetadata(const MDNode* mdNode) {
                 if (auto pointerDerivedType = dyn_cast_or_null<DIDerivedType>(elementDerivedType->getBaseType())) {
                     //pointerDerivedType->dump();
                     if (auto subroutineType = dyn_cast_or_null<DISubroutineType>(pointerDerivedType->getBaseType())) {
-                        typeAndOffsetToDebugTags[key] = computeDebugTag(subroutineType);
+                        index->typeAndOffsetToDebugTags[key] = computeDebugTag(subroutineType);
                     }
                 }
             }
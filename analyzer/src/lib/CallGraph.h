@@ -3,6 +3,31 @@
 
 #include "Analyzer.h"
 
+// Result of the part of the call graph initialization that only looks at a single module.
+// Modules are indexed independently of each other, doInitialization merges the indices in module order.
+struct CallGraphModuleIndex {
+	struct Alias {
+		Function *function;
+		StringRef name;
+		size_t hash;
+	};
+	struct Definition {
+		Function *function;
+		size_t hash;
+		bool addressTaken;
+	};
+
+	vector<Alias> aliases;
+	vector<Definition> definitions;
+
+	DenseMap<size_t, FuncSet> typeFuncsMap;
+	unordered_map<size_t, unordered_set<size_t>> typeConfineMap;
+	// In insertion order: lookups depend on the iteration order of typeTransitMap
+	vector<pair<size_t, size_t>> typeTransitions;
+	unordered_set<size_t> typeEscapeSet;
+	DenseMap<pair<StringRef, unsigned int>, string> typeAndOffsetToDebugTags;
+};
+
 class CallGraphPass : public IterativeModulePass {
 
 	private:
@@ -19,9 +44,14 @@ class CallGraphPass : public IterativeModulePass {
 		static unordered_map<size_t, unordered_set<size_t>>typeTransitMap;
 		static unordered_set<size_t>typeEscapeSet;
 
+		// Index the facts of the current module are collected in, see indexModule
+		CallGraphModuleIndex *index = nullptr;
+
 		// Use type-based analysis to find targets of indirect calls
 		void findCalleesWithType(llvm::CallInst*, FuncSet&);
 
+        static unique_ptr<CallGraphModuleIndex> indexModule(Module *M, GlobalContext *Ctx);
+
         bool collectFunctions(const Value* value, SmallPtrSet<const Function*, 1>& out, set<const Value*>& visited) const;
 
         void generateDotGraphOutput(const Function* F, int depth) const;
@@ -53,6 +83,13 @@ class CallGraphPass : public IterativeModulePass {
 		virtual bool doFinalization(llvm::Module *);
 		virtual void doModulePass(llvm::Module *);
 
+		// Builds the index of the module ahead of doInitialization, e.g. right after loading it.
+		// Can be called concurrently for distinct modules.
+		static void prepareModule(Module *M, GlobalContext *Ctx);
+
+		// Drops the type confinement state once all indirect calls are resolved.
+		static void releaseTypeAnalysis();
+
         DenseSet<const MDNode*> metadata;
         DenseMap<pair<StringRef, unsigned int>, string> typeAndOffsetToDebugTags;
 };
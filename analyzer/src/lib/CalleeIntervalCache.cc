@@ -0,0 +1,50 @@
+#include <mutex>
+#include "CalleeIntervalCache.h"
+
+
+AccumulatedCalleeIntervals CalleeIntervalCache::get(const CallInst* call, unsigned int returnValueIndex, ArrayRef<Function*> callees) {
+    auto key = make_pair(call, returnValueIndex);
+    auto epoch = store.epoch();
+    {
+        std::shared_lock _(lock);
+        auto it = entries.find(key);
+        // Nothing changed at all since the last validation: the common case once the intervals are settled
+        if (it != entries.end() && it->second.validAt == epoch)
+            return it->second.accumulated;
+    }
+
+    std::unique_lock _(lock);
+    auto [it, inserted] = entries.try_emplace(key, Entry {compute(returnValueIndex, callees), epoch});
+    if (!inserted) {
+        if (!isStillValid(it->second, returnValueIndex, callees))
+            it->second.accumulated = compute(returnValueIndex, callees);
+        it->second.validAt = epoch;
+    }
+    return it->second.accumulated;
+}
+
+bool CalleeIntervalCache::isStillValid(const Entry& entry, unsigned int returnValueIndex, ArrayRef<Function*> callees) const {
+    return all_of(callees, [&](const Function* callee) {
+        return store.versionOf(make_pair(callee, returnValueIndex)) <= entry.validAt;
+    });
+}
+
+AccumulatedCalleeIntervals CalleeIntervalCache::compute(unsigned int returnValueIndex, ArrayRef<Function*> callees) const {
+    auto& pool = IntervalPool::get();
+    AccumulatedCalleeIntervals result {false, pool.full(), pool.full(), pool.empty(), pool.empty()};
+    for (const auto* callee : callees) {
+        auto maybeInterval = store.maybeIntervalFor(make_pair(callee, returnValueIndex));
+        if (!maybeInterval.has_value())
+            continue;
+        auto interval = pool.intern(*maybeInterval.value());
+        result.anyPresent = true;
+        result.intersectionOfPresent = pool.intersection(result.intersectionOfPresent, interval);
+        if (interval->empty())
+            continue;
+        result.intersectionOfNonEmpty = pool.intersection(result.intersectionOfNonEmpty, interval);
+        result.unionOfNonEmpty = pool.union_(result.unionOfNonEmpty, interval);
+        if (!interval->full())
+            result.unionOfNonEmptyNonFull = pool.union_(result.unionOfNonEmptyNonFull, interval);
+    }
+    return result;
+}
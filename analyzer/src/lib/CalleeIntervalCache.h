@@ -0,0 +1,51 @@
+#pragma once
+
+#include <shared_mutex>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include "FunctionErrorReturnIntervals.h"
+#include "IntervalPool.h"
+
+// Error intervals of all possible callees of a call site, combined.
+struct AccumulatedCalleeIntervals {
+    // Whether any callee has an interval at all (possibly empty)
+    bool anyPresent;
+    // Intersection of all present intervals, full if none is present
+    IntervalRef intersectionOfPresent;
+    // Intersection of all non-empty intervals, full if there are none
+    IntervalRef intersectionOfNonEmpty;
+    // Union of all non-empty intervals, empty if there are none
+    IntervalRef unionOfNonEmpty;
+    // Union of all intervals that are neither empty nor full, empty if there are none
+    IntervalRef unionOfNonEmptyNonFull;
+};
+
+/**
+ * Per call site cache of the combined error intervals of its callees.
+ * An entry is only recomputed when the version of one of its contributing callees changed in the store.
+ * Thread-safe.
+ */
+class CalleeIntervalCache {
+public:
+    explicit CalleeIntervalCache(const FunctionErrorReturnIntervals& store) : store(store) {}
+
+    AccumulatedCalleeIntervals get(const CallInst* call, unsigned int returnValueIndex, ArrayRef<Function*> callees);
+
+    // Not synchronized with get()
+    [[nodiscard]] inline size_t size() const { return entries.size(); }
+    [[nodiscard]] inline size_t approximateHeapBytes() const { return entries.getMemorySize(); }
+
+private:
+    struct Entry {
+        AccumulatedCalleeIntervals accumulated;
+        // Store epoch at which the entry was last known to be up to date
+        uint64_t validAt;
+    };
+
+    [[nodiscard]] bool isStillValid(const Entry& entry, unsigned int returnValueIndex, ArrayRef<Function*> callees) const;
+    [[nodiscard]] AccumulatedCalleeIntervals compute(unsigned int returnValueIndex, ArrayRef<Function*> callees) const;
+
+    const FunctionErrorReturnIntervals& store;
+    std::shared_mutex lock;
+    DenseMap<pair<const CallInst*, unsigned int>, Entry> entries;
+};
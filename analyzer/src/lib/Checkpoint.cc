@@ -0,0 +1,436 @@
+#include <cstring>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Checkpoint.h"
+#include "Analyzer.h"
+#include "BinaryReader.h"
+#include "DataFlowAnalysis.h"
+
+namespace {
+
+constexpr char Magic[8] = {'E', 'S', 'S', 'S', 'C', 'K', 'P', 'T'};
+constexpr uint32_t Version = 2;
+constexpr uint32_t NoFunction = UINT32_MAX;
+
+// How a value referenced by a potential sanity check is stored, instructions and arguments relative to their function
+enum ValueKind : uint8_t {
+    NullValue,
+    InstructionValue,
+    ArgumentValue,
+    ConstantIntValue,
+    NamedGlobalValue,
+};
+
+// Stable identifiers of functions and calls: module index, function index, and instruction index for calls
+struct FunctionId {
+    uint32_t module, function;
+};
+
+class Writer {
+public:
+    Writer(raw_ostream& out, const GlobalContext& ctx) : out(out), writer(out, support::little) {
+        for (uint32_t m = 0, l = ctx.Modules.size(); m < l; ++m) {
+            uint32_t f = 0;
+            for (const auto& function : *ctx.Modules[m])
+                functionIds[&function] = FunctionId {m, f++};
+        }
+    }
+
+    template<typename T>
+    void write(T value) { writer.write<T>(value); }
+
+    void writeString(StringRef string) {
+        write<uint32_t>(string.size());
+        out << string;
+    }
+
+    void writeFunction(const Function* function) {
+        auto it = functionIds.find(function);
+        if (it == functionIds.end()) {
+            write<uint32_t>(NoFunction);
+            write<uint32_t>(NoFunction);
+        } else {
+            write<uint32_t>(it->second.module);
+            write<uint32_t>(it->second.function);
+        }
+    }
+
+    void writeCall(const CallInst* call) {
+        writeFunction(call->getFunction());
+        write<uint32_t>(instructionIndex(call));
+    }
+
+    uint32_t instructionIndex(const Instruction* instruction) {
+        auto& indices = instructionIndices[instruction->getFunction()];
+        if (indices.empty()) {
+            uint32_t index = 0;
+            for (const auto& other : instructions(instruction->getFunction()))
+                indices[&other] = index++;
+        }
+        return indices[instruction];
+    }
+
+    // Whether writeValue can store a value found in the function such that it reads back as the same value
+    static bool canWriteValue(const Function* function, const Value* value) {
+        if (!value)
+            return true;
+        if (const auto* instruction = dyn_cast<Instruction>(value))
+            return instruction->getFunction() == function;
+        if (const auto* argument = dyn_cast<Argument>(value))
+            return argument->getParent() == function;
+        if (const auto* constant = dyn_cast<ConstantInt>(value))
+            return constant->getBitWidth() <= 64;
+        if (const auto* global = dyn_cast<GlobalValue>(value))
+            return global->hasName() && global->getParent() == function->getParent();
+        return false;
+    }
+
+    static bool canWriteCondition(const Function* function, const pair<pair<const Value*, unsigned int>, const AbstractCondition*>& entry) {
+        const auto* condition = entry.second;
+        if (!canWriteValue(function, entry.first.first) || !canWriteValue(function, condition->getLhs()))
+            return false;
+        if (!condition->getOrigin() || condition->getOrigin()->getFunction() != function)
+            return false;
+        const auto* comparison = dyn_cast<AbstractComparison>(condition);
+        return !comparison || canWriteValue(function, comparison->getRhs());
+    }
+
+    void writeValue(const Value* value) {
+        if (!value) {
+            write<uint8_t>(NullValue);
+        } else if (const auto* instruction = dyn_cast<Instruction>(value)) {
+            write<uint8_t>(InstructionValue);
+            write<uint32_t>(instructionIndex(instruction));
+        } else if (const auto* argument = dyn_cast<Argument>(value)) {
+            write<uint8_t>(ArgumentValue);
+            write<uint32_t>(argument->getArgNo());
+        } else if (const auto* constant = dyn_cast<ConstantInt>(value)) {
+            write<uint8_t>(ConstantIntValue);
+            write<uint32_t>(constant->getBitWidth());
+            write<uint64_t>(constant->getValue().getZExtValue());
+        } else {
+            write<uint8_t>(NamedGlobalValue);
+            writeString(value->getName());
+        }
+    }
+
+private:
+    raw_ostream& out;
+    support::endian::Writer writer;
+    DenseMap<const Function*, FunctionId> functionIds;
+    DenseMap<const Function*, DenseMap<const Instruction*, uint32_t>> instructionIndices;
+};
+
+class Reader {
+public:
+    explicit Reader(StringRef data) : reader(data) {}
+
+    BinaryReader reader;
+    // Functions of the stored modules, by module index and function index
+    vector<vector<Function*>> functions;
+
+    bool readFunction(Function*& function) {
+        FunctionId id {};
+        if (!reader.read(id.module) || !reader.read(id.function))
+            return false;
+        if (id.module == NoFunction && id.function == NoFunction) {
+            function = nullptr;
+            return true;
+        }
+        if (id.module >= functions.size() || id.function >= functions[id.module].size())
+            return false;
+        function = functions[id.module][id.function];
+        return true;
+    }
+
+    bool readCall(CallInst*& call) {
+        Function* function;
+        uint32_t index;
+        if (!readFunction(function) || !function || !reader.read(index))
+            return false;
+        call = dyn_cast_or_null<CallInst>(instructionAt(function, index));
+        return call != nullptr;
+    }
+
+    Instruction* instructionAt(Function* function, uint32_t index) {
+        auto& instructionList = instructionLists[function];
+        if (instructionList.empty()) {
+            for (auto& instruction : instructions(function))
+                instructionList.push_back(&instruction);
+        }
+        return index < instructionList.size() ? instructionList[index] : nullptr;
+    }
+
+    bool readValue(Function* function, const Value*& value) {
+        uint8_t kind;
+        uint32_t index;
+        if (!reader.read(kind))
+            return false;
+        switch (kind) {
+            case NullValue:
+                value = nullptr;
+                return true;
+            case InstructionValue:
+                if (!reader.read(index))
+                    return false;
+                value = instructionAt(function, index);
+                return value != nullptr;
+            case ArgumentValue:
+                if (!reader.read(index) || index >= function->arg_size())
+                    return false;
+                value = function->getArg(index);
+                return true;
+            case ConstantIntValue: {
+                uint64_t bits;
+                if (!reader.read(index) || !reader.read(bits) || index == 0 || index > 64)
+                    return false;
+                value = ConstantInt::get(function->getContext(), APInt(index, bits));
+                return true;
+            }
+            case NamedGlobalValue: {
+                StringRef name;
+                if (!reader.readString(name))
+                    return false;
+                value = function->getParent()->getNamedValue(name);
+                return value != nullptr;
+            }
+            default:
+                return false;
+        }
+    }
+
+private:
+    DenseMap<const Function*, vector<Instruction*>> instructionLists;
+};
+
+}
+
+bool Checkpoint::write(StringRef path, const GlobalContext& ctx, StringRef parameters, string& error) {
+    error_code errorCode;
+    raw_fd_ostream out(path, errorCode);
+    if (errorCode) {
+        error = errorCode.message();
+        return false;
+    }
+
+    Writer writer(out, ctx);
+    out.write(Magic, sizeof(Magic));
+    writer.write<uint32_t>(Version);
+    writer.writeString(parameters);
+
+    writer.write<uint32_t>(ctx.Modules.size());
+    for (const auto* module : ctx.Modules) {
+        auto it = ctx.ModuleContentHashes.find(module);
+        writer.writeString(it == ctx.ModuleContentHashes.end() ? "" : it->second);
+    }
+
+    writer.write<uint32_t>(ctx.UnifiedFuncSet.size());
+    for (const auto* function : ctx.UnifiedFuncSet)
+        writer.writeFunction(function);
+
+    writer.write<uint32_t>(ctx.Callees.size());
+    for (const auto& [call, callees] : ctx.Callees) {
+        writer.writeCall(call);
+        writer.write<uint32_t>(callees.size());
+        for (const auto* callee : callees)
+            writer.writeFunction(callee);
+    }
+
+    // In store order, such that the inference replays in the same order
+    writer.write<uint32_t>(ctx.functionErrorReturnIntervals.size());
+    for (const auto& [key, interval] : ctx.functionErrorReturnIntervals) {
+        writer.writeFunction(key.first);
+        writer.write<uint32_t>(key.second);
+        writer.write<uint32_t>(interval.getRanges().size());
+        for (const auto& range : interval.getRanges()) {
+            writer.write<int32_t>(range.low);
+            writer.write<int32_t>(range.high);
+        }
+    }
+
+    writer.write<uint32_t>(ctx.functionToConfidence.size());
+    for (const auto& [key, confidence] : ctx.functionToConfidence) {
+        writer.writeFunction(key.first);
+        writer.write<uint32_t>(key.second);
+        writer.write<float>(confidence);
+    }
+
+    // Per function its potential sanity checks, or a marker to recompute them if they refer to values that cannot be stored
+    writer.write<uint32_t>(ctx.functionToSanityValuesAndConditions.size());
+    for (const auto& [function, conditions] : ctx.functionToSanityValuesAndConditions) {
+        writer.writeFunction(function);
+        bool stored = all_of(conditions, [function](const auto& entry) { return Writer::canWriteCondition(function, entry); });
+        writer.write<uint8_t>(stored);
+        if (!stored)
+            continue;
+        writer.write<uint32_t>(conditions.size());
+        for (const auto& [action, condition] : conditions) {
+            writer.writeValue(action.first);
+            writer.write<uint32_t>(action.second);
+            writer.write<uint8_t>(condition->getKind());
+            writer.write<uint8_t>(condition->isFromConditionalBranch());
+            writer.writeValue(condition->getLhs());
+            writer.write<uint32_t>(writer.instructionIndex(condition->getOrigin()));
+            if (const auto* comparison = dyn_cast<AbstractComparison>(condition)) {
+                writer.write<uint32_t>(comparison->getPredicate());
+                writer.writeValue(comparison->getRhs());
+            }
+        }
+    }
+    return true;
+}
+
+bool Checkpoint::read(StringRef path, GlobalContext& ctx, StringRef parameters, vector<const Function*>& recomputeSanityChecks, string& error) {
+    auto bufferOrError = MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+    if (!bufferOrError) {
+        error = bufferOrError.getError().message();
+        return false;
+    }
+
+    Reader reader((*bufferOrError)->getBuffer());
+    auto& in = reader.reader;
+    StringRef magic, storedParameters;
+    uint32_t version, moduleCount;
+    if (!in.readBytes(sizeof(Magic), magic) || memcmp(magic.data(), Magic, sizeof(Magic)) != 0) {
+        error = "not a checkpoint";
+        return false;
+    }
+    if (!in.read(version) || version != Version) {
+        error = "unsupported checkpoint version";
+        return false;
+    }
+    if (!in.readString(storedParameters) || storedParameters != parameters) {
+        error = "the checkpoint was created with different options: " + storedParameters.rtrim().str();
+        return false;
+    }
+
+    // Map the stored modules onto the loaded ones by content
+    StringMap<Module*> modulesByHash;
+    for (const auto& [module, hash] : ctx.ModuleContentHashes)
+        modulesByHash[hash] = const_cast<Module*>(module);
+    if (!in.read(moduleCount) || moduleCount != ctx.Modules.size()) {
+        error = "the checkpoint was created for a different set of inputs";
+        return false;
+    }
+    for (uint32_t m = 0; m < moduleCount; ++m) {
+        StringRef hash;
+        if (!in.readString(hash) || !modulesByHash.count(hash)) {
+            error = "the checkpoint was created for a different set of inputs";
+            return false;
+        }
+        auto& moduleFunctions = reader.functions.emplace_back();
+        for (auto& function : *modulesByHash[hash])
+            moduleFunctions.push_back(&function);
+    }
+
+    auto fail = [&]() {
+        error = "malformed checkpoint";
+        return false;
+    };
+
+    uint32_t count;
+    if (!in.read(count))
+        return fail();
+    for (uint32_t i = 0; i < count; ++i) {
+        Function* function;
+        if (!reader.readFunction(function) || !function)
+            return fail();
+        ctx.UnifiedFuncSet.insert(function);
+    }
+
+    if (!in.read(count))
+        return fail();
+    for (uint32_t i = 0; i < count; ++i) {
+        CallInst* call;
+        uint32_t calleeCount;
+        if (!reader.readCall(call) || !in.read(calleeCount))
+            return fail();
+        auto& callees = ctx.Callees[call];
+        for (uint32_t j = 0; j < calleeCount; ++j) {
+            Function* callee;
+            if (!reader.readFunction(callee) || !callee)
+                return fail();
+            callees.push_back(callee);
+            ctx.Callers[callee].insert(call);
+        }
+        // Same order as the call graph pass establishes
+        if (callees.size() > 1)
+            std::sort(callees.begin(), callees.end());
+    }
+
+    if (!in.read(count))
+        return fail();
+    for (uint32_t i = 0; i < count; ++i) {
+        Function* function;
+        uint32_t returnIndex, rangeCount;
+        if (!reader.readFunction(function) || !in.read(returnIndex) || !in.read(rangeCount))
+            return fail();
+        Interval interval(true);
+        for (uint32_t j = 0; j < rangeCount; ++j) {
+            int32_t low, high;
+            if (!in.read(low) || !in.read(high) || low > high)
+                return fail();
+            interval.appendUnsafeBecauseExpectsSortMaintained(Range(low, high));
+        }
+        ctx.functionErrorReturnIntervals.replaceIntervalFor(make_pair(function, returnIndex), std::move(interval));
+    }
+
+    if (!in.read(count))
+        return fail();
+    for (uint32_t i = 0; i < count; ++i) {
+        Function* function;
+        uint32_t returnIndex;
+        float confidence;
+        if (!reader.readFunction(function) || !in.read(returnIndex) || !in.read(confidence))
+            return fail();
+        ctx.functionToConfidence[make_pair(function, returnIndex)] = confidence;
+    }
+
+    if (!in.read(count))
+        return fail();
+    for (uint32_t i = 0; i < count; ++i) {
+        Function* function;
+        uint8_t stored;
+        uint32_t conditionCount;
+        if (!reader.readFunction(function) || !function || !in.read(stored))
+            return fail();
+        if (!stored) {
+            recomputeSanityChecks.push_back(function);
+            continue;
+        }
+        if (!in.read(conditionCount))
+            return fail();
+        auto& conditions = ctx.functionToSanityValuesAndConditions[function];
+        for (uint32_t j = 0; j < conditionCount; ++j) {
+            const Value* action;
+            const Value* lhs;
+            uint32_t actionIndex, originIndex;
+            uint8_t kind, fromConditionalBranch;
+            if (!reader.readValue(function, action) || !in.read(actionIndex) || !in.read(kind) || !in.read(fromConditionalBranch)
+                || !reader.readValue(function, lhs) || !in.read(originIndex))
+                return fail();
+            const auto* origin = reader.instructionAt(function, originIndex);
+            if (!origin)
+                return fail();
+            const AbstractCondition* condition;
+            if (kind == AbstractCondition::SK_AC) {
+                uint32_t predicate;
+                const Value* rhs;
+                if (!in.read(predicate) || !CmpInst::isIntPredicate(static_cast<CmpInst::Predicate>(predicate)) || !reader.readValue(function, rhs))
+                    return fail();
+                condition = new AbstractComparison(static_cast<ICmpInst::Predicate>(predicate), lhs, rhs, origin, fromConditionalBranch);
+            } else if (kind == AbstractCondition::SK_FB) {
+                condition = new AbstractFallback(lhs, origin);
+            } else {
+                return fail();
+            }
+            conditions.emplace_back(make_pair(action, actionIndex), condition);
+        }
+    }
+
+    if (!in.atEnd())
+        return fail();
+    return true;
+}
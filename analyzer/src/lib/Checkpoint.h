@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+
+namespace llvm { class Function; }
+struct GlobalContext;
+
+/**
+ * Checkpoint of the global context after the specification inference, such that the bug detection can be re-run
+ * with different thresholds without redoing the inference. It holds the call graph, the unified functions, and the
+ * learned intervals and confidences, and the potential sanity checks. Functions are identified by the content hash of their module and their index in
+ * it, calls by the index of the instruction in their function, so a checkpoint can only be resumed on the same inputs.
+ * Functions whose potential sanity checks refer to values that cannot be identified this way are returned by read, their
+ * checks need to be recomputed from the IR.
+ *
+ * The parameters string describes the options the inference ran with, resuming fails if they differ.
+ */
+namespace Checkpoint {
+
+bool write(llvm::StringRef path, const GlobalContext& ctx, llvm::StringRef parameters, std::string& error);
+bool read(llvm::StringRef path, GlobalContext& ctx, llvm::StringRef parameters, std::vector<const llvm::Function*>& recomputeSanityChecks,
+          std::string& error);
+
+}
@@ -0,0 +1,92 @@
+// Definitions of the command line options and the global context that are shared by the analysis passes.
+// The options that only the driver reads are defined in Analyzer.cc.
+
+#include "Analyzer.h"
+#include "ClOptForward.h"
+
+cl::opt<string> CacheDirectory(
+        "cache-dir",
+        cl::desc("Directory to cache per-module analysis results in across runs, keyed by the content of the bitcode files"),
+        cl::NotHidden, cl::init(""));
+
+cl::opt<string> ReportCandidatesFile(
+        "report-candidates",
+        cl::desc("Write every report candidate with its score to this file, such that thresholds can be applied offline"),
+        cl::NotHidden, cl::init(""));
+
+cl::list<float> SweepMissingThresholds(
+        "sweep-missing-ct",
+        cl::desc("Write the reports for each of these (comma separated) missing check thresholds to <sweep-output>/missing-ct-<threshold>"),
+        cl::CommaSeparated, cl::NotHidden);
+
+cl::opt<string> SweepDirectory(
+        "sweep-output",
+        cl::desc("Directory for the reports of --sweep-missing-ct"),
+        cl::NotHidden, cl::init("sweep"));
+
+cl::opt<bool> SpeculativePropagation(
+        "speculative-propagation",
+        cl::desc("With multiple threads, compute the propagation of error intervals to callers ahead in parallel waves"),
+        cl::NotHidden, cl::init(false));
+
+cl::opt<bool> ProgressiveReport(
+        "progressive-report",
+        cl::desc("Report the bugs of a call during the incorrect check detection, as soon as the scores of its callees are final"),
+        cl::NotHidden, cl::init(false));
+
+cl::opt<unsigned> VerboseLevel(
+    "verbose-level", cl::desc("Print information at which verbose level"),
+    cl::init(0));
+
+cl::opt<unsigned int> ThreadCount(
+        "c",
+        cl::desc("The amount of threads to use"),
+        cl::NotHidden, cl::init(2));
+
+#if 1
+cl::opt<float> AssociationConfidence(
+        "st",
+        cl::desc("Association analysis confidence between [0, 1]. The higher the more confident the association must be."),
+        cl::NotHidden, cl::init(0.925f));
+cl::opt<float> IntervalConfidenceThreshold(
+        "interval-ct",
+        cl::desc("Confidence threshold between [0, 1]. The higher the more similar the error intervals should be."),
+        cl::NotHidden, cl::init(0.5f));
+cl::opt<bool> ShowSafetyChecks(
+        "ssc",
+        cl::desc("Show safety checks."),
+        cl::NotHidden, cl::init(false));
+cl::opt<unsigned int> PrintRandomNonVoidFunctionSamples(
+        "print-random-non-void-function-samples",
+        cl::desc("How many random non-void function names to print, useful for sampling functions to compute a recall"),
+        cl::NotHidden, cl::init(0));
+cl::opt<bool> RefineWithVSA(
+        "refine-vsa",
+        cl::desc("Refine error intervals using VSA."),
+        cl::NotHidden, cl::init(true));
+cl::opt<float> IncorrectCheckThreshold(
+        "incorrect-ct",
+        cl::desc("Incorrect check threshold between [0, 1]."),
+        cl::NotHidden, cl::init(0.725f));
+cl::opt<float> MissingCheckThreshold(
+        "missing-ct",
+        cl::desc("Missing check threshold between [0, 1]."),
+        cl::NotHidden, cl::init(0.725f));
+#endif
+cl::opt<MLTAMode> MLTA(
+        "mlta-mode",
+        cl::desc("Sets in which mode MLTA runs"),
+        cl::values(
+                clEnumVal(NoIndirectCalls, "No indirect call analysis"),
+                clEnumVal(MatchSignatures, "Consider all matching type signatures as possible call targets"),
+                clEnumVal(FullMLTA, "Full MLTA implementation")
+        ),
+        cl::NotHidden, cl::init(FullMLTA)
+);
+
+cl::opt<string> FunctionTestCasesToAnalyze(
+        "function-test-cases-to-analyzer",
+        cl::desc("An allowlist (comma separated) that specifies which functions to run through the analyzer as a means of testing."),
+        cl::NotHidden, cl::init(""));
+
+GlobalContext GlobalCtx;
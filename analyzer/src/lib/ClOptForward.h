@@ -20,6 +20,12 @@ extern cl::opt<float> MissingCheckThreshold;
 extern cl::opt<MLTAMode> MLTA;
 extern cl::opt<string> FunctionTestCasesToAnalyze;
 extern cl::opt<unsigned int> ThreadCount;
+extern cl::opt<string> CacheDirectory;
+extern cl::opt<string> ReportCandidatesFile;
+extern cl::list<float> SweepMissingThresholds;
+extern cl::opt<string> SweepDirectory;
+extern cl::opt<bool> SpeculativePropagation;
+extern cl::opt<bool> ProgressiveReport;
 
 struct GlobalContext;
 extern GlobalContext GlobalCtx;
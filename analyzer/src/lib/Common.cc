@@ -1,10 +1,91 @@
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/ADT/StringMap.h>
 #include <fstream>
+#include <mutex>
+#include <numeric>
 #include "Common.h"
 #include <regex>
 
+static mutex FileNamesLock;
+static StringMap<unsigned int> FileIds;
+// By id - 1, the keys of FileIds
+static vector<StringRef> FileNames;
+
+unsigned int internFileName(StringRef fileName) {
+    lock_guard<mutex> guard(FileNamesLock);
+    // Ids start at 1, 0 is left for locations without debug information
+    auto [it, inserted] = FileIds.try_emplace(fileName, FileIds.size() + 1);
+    if (inserted)
+        FileNames.push_back(it->first());
+    return it->second;
+}
+
+StringRef internedFileName(unsigned int fileId) {
+    lock_guard<mutex> guard(FileNamesLock);
+    return fileId == 0 ? StringRef() : FileNames[fileId - 1];
+}
+
+vector<size_t> SourceLocation::sourceOrder(ArrayRef<const SourceLocation*> locations) {
+    // The files of the locations without debug information are interned first, such that one snapshot ranks them all
+    vector<pair<unsigned int, unsigned int>> fileIdsAndLines;
+    fileIdsAndLines.reserve(locations.size());
+    for (const auto* location : locations) {
+        if (location->isValid())
+            fileIdsAndLines.emplace_back(location->SCheckFileId, location->SCheckLineNo);
+        else if (auto subProgram = location->v->getFunction()->getSubprogram())
+            fileIdsAndLines.emplace_back(internFileName(subProgram->getFilename()), subProgram->getLine());
+        else
+            fileIdsAndLines.emplace_back(0, 0);
+    }
+
+    // By file id, the rank of the file name among all interned names, 0 for no file
+    vector<unsigned int> fileNameRanks;
+    {
+        lock_guard<mutex> guard(FileNamesLock);
+        vector<unsigned int> fileIds(FileNames.size());
+        iota(fileIds.begin(), fileIds.end(), 1);
+        std::sort(fileIds.begin(), fileIds.end(), [](unsigned int a, unsigned int b) { return FileNames[a - 1] < FileNames[b - 1]; });
+        fileNameRanks.resize(FileNames.size() + 1);
+        for (size_t rank = 0; rank < fileIds.size(); ++rank)
+            fileNameRanks[fileIds[rank]] = rank + 1;
+    }
+
+    vector<pair<uint64_t, StringRef>> keys;
+    keys.reserve(locations.size());
+    for (size_t i = 0; i < locations.size(); ++i) {
+        auto [fileId, line] = fileIdsAndLines[i];
+        keys.emplace_back(static_cast<uint64_t>(fileNameRanks[fileId]) << 32 | line,
+                          locations[i]->isValid() ? StringRef() : locations[i]->v->getFunction()->getName());
+    }
+    vector<size_t> order(locations.size());
+    iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+void SourceLocation::print(raw_ostream& output) const {
+    if (!isValid()) {
+        // Note: printing the LLVM instruction is very slow!
+        //string tmp;
+        //raw_string_ostream rso(tmp);
+        //v->print(rso);
+        //string_view view(tmp);
+        //output << "Unknown source code location, IR instruction: <" << view.substr(2, view.size() - 1) << ">";
+        if (auto subProgram = v->getFunction()->getSubprogram()) {
+            output << subProgram->getFilename() << ": ~" << subProgram->getLine() << "~";
+        } else {
+            output << "?: ?";
+        }
+    } else {
+        output << internedFileName(SCheckFileId) << ": " << SCheckLineNo;
+        if (SInlinedAtFileId != 0) {
+            output << " (inlined at " << internedFileName(SInlinedAtFileId) << ": " << SInlinedAtLineNo << ")";
+        }
+    }
+}
+
 bool trimPathSlash(string& path, int slash) {
     while (slash > 0) {
         path = path.substr(path.find('/') + 1);
@@ -10,24 +10,36 @@
 #include <unistd.h>
 //#include <chrono>
 #include <optional>
+#include <tuple>
+
+#include "Log.h"
 
 using namespace llvm;
 using namespace std;
 
 #define LOG_INFO 0
 #define LOG_VERBOSE 1
+// Diagnostic dumps of the analysis internals
+#define LOG_DEBUG 2
+
+// Constant levels above this are compiled out, build with -DLOG_MAX_LEVEL=LOG_DEBUG to get the diagnostic dumps
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_VERBOSE
+#endif
+
+#define LOG_ENABLED(lv) ((lv) <= LOG_MAX_LEVEL && VerboseLevel >= (lv))
 
 #define LOG(lv, stmt)                            \
     do {                                            \
-        if (VerboseLevel >= lv)                        \
-        errs() << stmt;                            \
+        if (LOG_ENABLED(lv))                           \
+            Log::stream() << stmt;                     \
     } while(0)
 
 
-#define OP llvm::errs()
+#define OP Log::stream()
 
 extern cl::opt<unsigned> VerboseLevel;
-extern const DataLayout *CurrentLayout;
+extern thread_local const DataLayout *CurrentLayout;
 
 //
 // Common functions
@@ -54,45 +66,40 @@ string HandleSimpleTy(const Type *Ty);
 
 string expand_struct(const StructType *STy);
 
+// Interns a source file name, such that source locations compare and hash as integers. Thread-safe.
+// The ids depend on the order in which the threads intern the names, so they are not stable across runs.
+unsigned int internFileName(StringRef fileName);
+StringRef internedFileName(unsigned int fileId);
+
 struct SourceLocation {
     explicit SourceLocation(const Instruction *v, bool followInlines=true) : v(v) {
         const auto &dbgLoc = v->getDebugLoc();
         auto diNode = dbgLoc.get();
         if (diNode && dbgLoc.getLine() >= 1) {
-            SCheckFileName = diNode->getFilename();
+            SCheckFileId = internFileName(diNode->getFilename());
             SCheckLineNo = dbgLoc.getLine();
-        }
-
-        raw_string_ostream output(cachedOutputString);
-        if (!isValid()) {
-            // Note: printing the LLVM instruction is very slow!
-            //string tmp;
-            //raw_string_ostream rso(tmp);
-            //v->print(rso);
-            //string_view view(tmp);
-            //output << "Unknown source code location, IR instruction: <" << view.substr(2, view.size() - 1) << ">";
-            if (auto subProgram = v->getFunction()->getSubprogram()) {
-                output << subProgram->getFilename() << ": ~" << subProgram->getLine() << "~";
-            } else {
-                output << "?: ?";
-            }
-        } else {
-            output << SCheckFileName << ": " << SCheckLineNo;
-            if (followInlines && (diNode = diNode->getInlinedAt())) {
-                output << " (inlined at " << diNode->getFilename() << ": " << diNode->getLine() << ")";
+            if (followInlines) {
+                if (auto inlinedAt = diNode->getInlinedAt()) {
+                    SInlinedAtFileId = internFileName(inlinedAt->getFilename());
+                    SInlinedAtLineNo = inlinedAt->getLine();
+                }
             }
         }
-        output.flush();
     }
 
     bool operator==(const SourceLocation &b) const {
         if (SCheckLineNo == 0) {
             return v == b.v;
         } else {
-            return SCheckLineNo == b.SCheckLineNo && SCheckFileName == b.SCheckFileName;
+            return SCheckLineNo == b.SCheckLineNo && SCheckFileId == b.SCheckFileId;
         }
     }
 
+    // Permutation that puts the locations into source order by file name and line, the same in every run unlike the
+    // order of the file ids. Locations without debug information go by the file and line of their function, and then
+    // its name. The file names are ranked once up front, so the sort compares integers and takes no lock.
+    static vector<size_t> sourceOrder(ArrayRef<const SourceLocation*> locations);
+
     [[nodiscard]] bool isValid() const {
         return SCheckLineNo > 0;
     }
@@ -101,28 +108,31 @@ struct SourceLocation {
         return isValid() || v->getFunction()->getSubprogram();
     }
 
+    // Formats the location from the interned file names, only when it is printed
+    void print(raw_ostream &output) const;
+
     void dumpToStringStream(raw_string_ostream &output) const {
-        output << cachedOutputString;
+        print(output);
     }
 
     void dump(unsigned int level = LOG_INFO) const {
-        if (VerboseLevel >= level) {
-            OP << cachedOutputString;
+        if (LOG_ENABLED(level)) {
+            print(OP);
         }
     }
 
-    StringRef SCheckFileName; /* Source file name of security check */
+    unsigned SCheckFileId{};  /* Interned source file name of security check */
     unsigned SCheckLineNo{};  /* Line number of security check */
+    unsigned SInlinedAtFileId{};  /* Interned source file name of the call the check is inlined at, 0 if not inlined */
+    unsigned SInlinedAtLineNo{};  /* Line number of the call the check is inlined at */
 
 private:
     const Instruction *v;
-    string cachedOutputString;
 };
 
 struct SourceLocationHasher {
     size_t operator()(const SourceLocation& sourceLocation) const {
-        hash<unsigned> hl;
-        return hl(sourceLocation.SCheckLineNo) * 6700417 + hash_value(sourceLocation.SCheckFileName);
+        return static_cast<size_t>(sourceLocation.SCheckLineNo) * 6700417 + sourceLocation.SCheckFileId;
     }
 };
 
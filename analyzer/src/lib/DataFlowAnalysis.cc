@@ -15,6 +15,7 @@
 #include "DataFlowAnalysis.h"
 #include "Helpers.h"
 #include "DebugHelpers.h"
+#include "Statistics.h"
 
 
 //#define DEBUG_PRINT_VALUE_RESOLUTION
@@ -39,10 +40,10 @@ optional<int> DataFlowAnalysis::computeRhs(const AbstractComparison& comparison)
     if (rhs.has_value()) {
         return rhs;
     } else {
-        if (VerboseLevel >= LOG_VERBOSE) {
+        if (LOG_ENABLED(LOG_VERBOSE)) {
             LOG(LOG_VERBOSE, "Can't derive rhs\n");
             comparison.dump();
-            comparison.getRhs()->dump();
+            OP << *comparison.getRhs() << "\n";
             if (auto I = dyn_cast<Instruction>(comparison.getRhs())) {
                 SourceLocation{I}.dump(LOG_INFO);
                 LOG(LOG_INFO, "\n");
@@ -133,7 +134,7 @@ const Value* DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPathResol
 #ifdef DEBUG_PRINT_VALUE_RESOLUTION
     if (load->getParent()->getParent()->getName().equals("mbfl_filt_conv_html_dec")){
     LOG(LOG_INFO, "findUndisputedValueWithoutLeavingCurrentPathResolveLoad\n");
-    load->dump();
+    OP << *load << "\n";
     SourceLocation{load}.dump(LOG_INFO);
     LOG(LOG_INFO, "\n");}
 #endif
@@ -162,6 +163,7 @@ const Value* DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPathResol
                 if (candidateOffset == offset && base != baseForCandidate) {
                     auto aaIt = GlobalCtx.AAPass.find(load->getModule());
                     assert(aaIt != GlobalCtx.AAPass.end());
+                    Statistics::AliasQueries.increment();
                     if (aaIt->second->getAAResults().alias(base, baseForCandidate) >= AliasResult::MayAlias)
                         return candidateGEP;
                 }
@@ -243,7 +245,7 @@ const Value* DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(cons
 
 #ifdef DEBUG_PRINT_VALUE_RESOLUTION
     LOG(LOG_INFO, "findUndisputedValueWithoutLeavingCurrentPath: ");
-    value->dump();
+    OP << *value << "\n";
     if (auto I = dyn_cast<Instruction>(value))
         SourceLocation{I}.dump(LOG_INFO);
     LOG(LOG_INFO, "\n");
@@ -384,8 +386,8 @@ const Value* DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(cons
                                     returnValue = _case.getCaseValue()->getValue().ule(cmpOp1Constant->getValue());
                                 } else {
                                     LOG(LOG_INFO, "Unsupported predicate: " << cmp->getPredicate() << "\n");
-                                    _case.getCaseValue()->dump();
-                                    cmpOp1->dump();
+                                    OP << *_case.getCaseValue() << "\n";
+                                    OP << *cmpOp1 << "\n";
                                     assert(false && "todo");
                                 }
 
@@ -478,10 +480,10 @@ void DataFlowAnalysis::getPotentialSanityCheck(const BasicBlock& BB, const std::
             if (comparand && (isa<CallInst>(comparand) || /*isa<GetElementPtrInst>(comparand) || isa<Argument>(comparand) || */isa<ICmpInst>(comparand) /* propagate up */)) {
                 if (debug) {
                     LOG(LOG_INFO, "getPotentialSanityCheck success:\n");
-                    lhs->dump();
+                    OP << *lhs << "\n";
                     SourceLocation{lhs}.dump(LOG_INFO);
                     LOG(LOG_INFO, "\nComparand: ");
-                    comparand->dump();
+                    OP << *comparand << "\n";
                 }
 
                 //LOG(LOG_INFO, "Success\n");
@@ -489,10 +491,10 @@ void DataFlowAnalysis::getPotentialSanityCheck(const BasicBlock& BB, const std::
             } else {
                 if (debug) {
                     LOG(LOG_INFO, "getPotentialSanityCheck failure:\n");
-                    lhs->dump();
+                    OP << *lhs << "\n";
                     SourceLocation{lhs}.dump(LOG_INFO);
                     LOG(LOG_INFO, "\nComparand: " << comparand << "  ");
-                    if (comparand) comparand->dump();
+                    if (comparand) OP << *comparand << "\n";
                     dumpPathList(blocks.blocks);
                 }
             }
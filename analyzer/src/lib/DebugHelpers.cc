@@ -19,11 +19,11 @@ string getBasicBlockName(const BasicBlock* BB) {
 void dumpDebugValue(const Function* function) {
     for (const auto& instruction : instructions(function)) {
 		if (auto dbg = dyn_cast<DbgDeclareInst>(&instruction)) {
-			dbg->getAddress()->getType()->dump();
-			dbg->getAddress()->dump();
+			OP << *dbg->getAddress()->getType() << "\n";
+			OP << *dbg->getAddress() << "\n";
 		} else if (auto dbg = dyn_cast<DbgValueInst>(&instruction)) {
-			dbg->getValue()->getType()->dump();
-			dbg->getValue()->dump();
+			OP << *dbg->getValue()->getType() << "\n";
+			OP << *dbg->getValue() << "\n";
 		}
 	}
 }
@@ -6,7 +6,11 @@
 #include <llvm/IR/Value.h>
 #include <llvm/IR/CFG.h>
 #include <llvm/Analysis/CallGraph.h>
-#include <stack>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/Support/ThreadPool.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
 
 #include "EHBlockDetector.h"
 #include "Common.h"
@@ -16,6 +20,9 @@
 #include "Interval.h"
 #include "ClOptForward.h"
 #include "FunctionVSA.h"
+#include "Statistics.h"
+#include "FunctionProfiler.h"
+#include "ReportWriter.h"
 
 
 //#define VERY_VERBOSE_DUMP_OF_MATCH
@@ -78,12 +85,12 @@ void Summary::dump() const {
         } else if (entry.type == OperationType::Return) {
             LOG(LOG_INFO, "    RETURN ");
             if (entry.returnData.resolvedValue) {
-                entry.returnData.resolvedValue->dump();
+                OP << *entry.returnData.resolvedValue << "\n";
             } else {
                 LOG(LOG_INFO, "(no resolved value)");
             }
             if (entry.returnData.unresolvedValue) {
-                entry.returnData.unresolvedValue->dump();
+                OP << *entry.returnData.unresolvedValue << "\n";
             } else {
                 LOG(LOG_INFO, "(null)");
             }
@@ -93,7 +100,7 @@ void Summary::dump() const {
         } else if (entry.type == OperationType::CondBr) {
             LOG(LOG_INFO, "    CONDBR " << entry.predicate << " " << entry.condBrData.instruction << " " << entry.condBrData.value << " ");
             if (entry.condBrData.value)
-                entry.condBrData.value->dump();
+                OP << *entry.condBrData.value << "\n";
             else
                 LOG(LOG_INFO, "\n");
         } else if (entry.type == OperationType::Switch) {
@@ -101,7 +108,7 @@ void Summary::dump() const {
         } else if (entry.type == OperationType::Store) {
             LOG(LOG_INFO, "    STORE ");
             if (entry.storeData.value)
-                entry.storeData.value->dump();
+                OP << *entry.storeData.value << "\n";
             LOG(LOG_INFO, "\n");
         } else {
             assert(false && "unimplemented");
@@ -169,6 +176,7 @@ bool Operation::operator==(const Operation& other) const {
             return false;
         if (!storeData.aa)
             return storeData.value == other.storeData.value;
+        Statistics::AliasQueries.increment();
         if (storeData.aa->alias(storeData.value, other.storeData.value) >= AliasResult::MayAlias)
             return true;
         return areInlinedEquivalent(storeData.instruction, other.storeData.instruction);
@@ -186,6 +194,7 @@ static const Value* resolveValueAlongPath(const Value* value, const vector<const
         return value;
     auto instruction = cast<Instruction>(value);
     PHISet phiSet;
+    FunctionProfiler::count(FunctionProfiler::Work::Resolutions);
     return DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(value, instruction, PathSpan{blocks, false}, phiSet);
 }
 
@@ -206,27 +215,6 @@ void Summary::resolvePathSensitiveValues(const vector<const BasicBlock*>& blocks
         op.resolvePathSensitiveValues(blocks);
 }
 
-template<typename T>
-static bool isEitherSubsequenceOfTheOther(const vector<T> &aVec, const vector<T> &bVec, unsigned short &lcsOut) {
-    // Shortest one should be in a
-    span<const T> a = aVec, b = bVec;
-    if (a.size() > b.size()) {
-        swap(a, b);
-    }
-
-    size_t aIdx = 0;
-    size_t diff = b.size() - a.size(); // >= 0 because |a| <= |b|
-    // Note: aIdx <= bIdx
-    for (size_t bIdx = 0; aIdx < a.size() && diff >= bIdx - aIdx /* checks if remaining for b >= remaining for a */; ++bIdx) {
-        if (a[aIdx] == b[bIdx]) {
-            ++aIdx;
-        }
-    }
-
-    lcsOut = a.size();
-    return aIdx == a.size();
-}
-
 Summary EHBlockDetectorPass::summarizeBlock(const BasicBlock* currentBlock) const {
     Summary summary;
 
@@ -254,9 +242,11 @@ Summary EHBlockDetectorPass::summarizeBlock(const BasicBlock* currentBlock) cons
                     .callTargets = &calleesIt->second,
                 });
             } else {
-                CI->dump();
-                SourceLocation{CI}.dump(LOG_INFO);
-                LOG(LOG_INFO, '\n');
+                if (LOG_ENABLED(LOG_DEBUG)) {
+                    OP << "No callees for " << *CI << " ";
+                    SourceLocation{CI}.dump(LOG_DEBUG);
+                    OP << '\n';
+                }
                 continue;
             }
         } else if (auto ret = dyn_cast<ReturnInst>(&instruction)) {
@@ -318,6 +308,7 @@ Summary EHBlockDetectorPass::summarizeBlock(const BasicBlock* currentBlock) cons
 }
 
 void EHBlockDetectorPass::collectPaths(const BasicBlock* currentBlock, vector<Path*>& allPaths, Path* myCurrentPath, set<const BasicBlock*>& basicBlocksOfNonInterest) {
+    Statistics::PathsEnumerated.increment();
     set<const BasicBlock*> visited;
     collectPathsAux(currentBlock, allPaths, myCurrentPath, visited, basicBlocksOfNonInterest, nullptr);
 }
@@ -366,6 +357,7 @@ void EHBlockDetectorPass::collectPathsAux(const BasicBlock* currentBlock, vector
                 collectPathsAux(successor, allPaths, myCurrentPath, visited, basicBlocksOfNonInterest, lastBr);
             } else {
                 set<const BasicBlock*> visitedClone{visited};
+                Statistics::PathsEnumerated.increment();
                 auto newCurrentPath = new Path();
                 newCurrentPath->reason = myCurrentPath->reason;
                 newCurrentPath->blocks.reserve(myCurrentPath->blocks.size());
@@ -378,7 +370,7 @@ void EHBlockDetectorPass::collectPathsAux(const BasicBlock* currentBlock, vector
     }
 }
 
-void EHBlockDetectorPass::identifyPotentialSanityChecks(const Function& function) {
+void EHBlockDetectorPass::identifyPotentialSanityChecks(const Function& function, SanityValuesAndConditions& out) const {
     for (const auto& BB : function) {
         auto handle = [&](const AbstractCondition* cmp, pair<const Value*, unsigned int> value) {
 #if 0
@@ -390,20 +382,44 @@ void EHBlockDetectorPass::identifyPotentialSanityChecks(const Function& function
                 delete cmp;
                 return;
             }
-            Ctx->functionToSanityValuesAndConditions[&function].emplace_back(make_pair(value, cmp));
+            out.emplace_back(make_pair(value, cmp));
         };
         DataFlowAnalysis::getPotentialSanityCheck(BB, handle);
     }
 }
 
 // Note: runs non-concurrently
+void EHBlockDetectorPass::run(const std::vector<llvm::Module *> &modules, bool multithreaded) {
+    if (stage == 0) {
+        // Create the entries up front, such that the concurrent initializations only look them up
+        for (auto* M : modules) {
+            Ctx->AAPass.emplace(M, nullptr);
+            moduleToSafetyChecks[M] = {};
+        }
+    }
+    IterativeModulePass::run(modules, multithreaded);
+}
+
 bool EHBlockDetectorPass::doInitialization(Module *M) {
     if (stage != 0)
         return false;
 
+    initializeAliasAnalysis(M);
+    for (const auto& function : *M) {
+        if (!Ctx->shouldSkipFunction(&function))
+            collectPotentialSanityChecks(function);
+    }
+
+    return false;
+}
+
+void EHBlockDetectorPass::initializeAliasAnalysis(Module *M) {
     auto functionPassManager = new legacy::FunctionPassManager(M);
-    Ctx->AAPass[M] = new AAResultsWrapperPass();
-    functionPassManager->add(Ctx->AAPass[M]);
+    auto aaPassIt = Ctx->AAPass.find(M);
+    if (aaPassIt == Ctx->AAPass.end())
+        aaPassIt = Ctx->AAPass.emplace(M, nullptr).first;
+    aaPassIt->second = new AAResultsWrapperPass();
+    functionPassManager->add(aaPassIt->second);
     functionPassManager->doInitialization();
     for (const auto &function: *M) {
         if (!Ctx->shouldSkipFunction(&function)) {
@@ -412,16 +428,15 @@ bool EHBlockDetectorPass::doInitialization(Module *M) {
     }
 
     functionPassManager->doFinalization();
+}
 
-    for (const auto& function : *M) {
-        if (!Ctx->shouldSkipFunction(&function))
-            identifyPotentialSanityChecks(function);
+void EHBlockDetectorPass::collectPotentialSanityChecks(const Function& function) {
+    SanityValuesAndConditions sanityValuesAndConditions;
+    identifyPotentialSanityChecks(function, sanityValuesAndConditions);
+    if (!sanityValuesAndConditions.empty()) {
+        lock_guard _(sanityValuesAndConditionsLock);
+        Ctx->functionToSanityValuesAndConditions[&function] = std::move(sanityValuesAndConditions);
     }
-
-    // Pre-init this such that concurrent accesses are possible
-    moduleToSafetyChecks[M] = {};
-
-    return false;
 }
 
 bool EHBlockDetectorPass::doFinalization(Module *M) {
@@ -460,28 +475,34 @@ void EHBlockDetectorPass::storeData() {
         }
     }
 #if 1
+    auto& pool = IntervalPool::get();
     for (auto& [pair, intervalCounts] : functionToIntervalCounts) {
-        auto it = intervalCounts.begin();
-        auto end = intervalCounts.end();
-        while (it != end) {
+        // A merge reads counts that earlier merges already changed, so the outcome depends on the order in which the
+        // intervals are visited. The map is ordered by the insertion order, which differs between eager and lazy
+        // loading and between thread counts: visit the intervals sorted by their ranges instead.
+        std::vector<IntervalHashMap::value_type*> entries;
+        entries.reserve(intervalCounts.size());
+        for (auto& entry : intervalCounts)
+            entries.push_back(&entry);
+        std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) { return *a->first < *b->first; });
+
+        for (auto* it : entries) {
             if (it->second > 0) {
                 // Find compatible interval
-                for (auto itCopy = intervalCounts.begin(); itCopy != end; ++itCopy) {
+                for (auto* itCopy : entries) {
                     if (pair.first->empty()) {
                         // Remove duplicates that were already merged
-                        if (itCopy != it && itCopy->second > 0 && itCopy->second <= it->second && it->first.isSubsetOf(itCopy->first)) {
+                        if (itCopy != it && itCopy->second > 0 && itCopy->second <= it->second && pool.isSubsetOf(it->first, itCopy->first)) {
                             it->second += itCopy->second;
                             itCopy->second = 0;
                         }
                     } else {
-                        if (itCopy != it && itCopy->second > 0 && itCopy->second <= it->second && itCopy->first.isSubsetOf(it->first)) {
+                        if (itCopy != it && itCopy->second > 0 && itCopy->second <= it->second && pool.isSubsetOf(itCopy->first, it->first)) {
                             it->second += itCopy->second;
                         }
                     }
                 }
             }
-
-            ++it;
         }
     }
 #endif
@@ -510,13 +531,14 @@ void EHBlockDetectorPass::storeData() {
 
 #ifdef DUMP_CONFIDENCE_INFO
             LOG(LOG_INFO, "\t");
-            interval.dump();
+            interval->dump();
             LOG(LOG_INFO, "\tConfidence: " << format("%.2f", fraction * 100.0f) << "%, " << count << "/" << (unsigned int) sum << "\n");
 #endif
 
             if (fraction >= IntervalConfidenceThreshold) {
-                auto& targetInterval = Ctx->functionErrorReturnIntervals.intervalFor(pair);
-                targetInterval.intersectionInPlace(interval);
+                Ctx->functionErrorReturnIntervals.updateIntervalFor(pair, [&](Interval& targetInterval) {
+                    targetInterval.intersectionInPlace(*interval);
+                });
                 intersected = true;
                 ++intervalCountsIt;
             } else {
@@ -529,7 +551,7 @@ void EHBlockDetectorPass::storeData() {
         if (!intersected) {
             LOG(LOG_VERBOSE, "Dropped " << function->getName() << " due to low confidence, falling back to empty interval\n");
             // Empty interval indicates it must be checked, but not how. The following line creates an empty interval.
-            Ctx->functionErrorReturnIntervals.intervalFor(pair).clear();
+            Ctx->functionErrorReturnIntervals.updateIntervalFor(pair, [](Interval& interval) { interval.clear(); });
         }
 
         // Note: we still need this data to compare support and confidence in case of inheriting error intervals
@@ -550,7 +572,7 @@ void EHBlockDetectorPass::storeData() {
                     if (auto ret = dyn_cast<ReturnInst>(callerFunction->begin()->getTerminator())) {
                         if (auto call = dyn_cast_or_null<CallInst>(ret->getReturnValue())) {
                             if (call->getCalledFunction() == pair.first) {
-                                Ctx->functionErrorReturnIntervals.intervalFor(make_pair(callerFunction, 0), true).clear();
+                                Ctx->functionErrorReturnIntervals.updateIntervalFor(make_pair(callerFunction, 0), [](Interval& callerInterval) { callerInterval.clear(); }, true);
                                 LOG(LOG_INFO, "Empty " << callerFunction->getName() << "\n");
                             }
                         }
@@ -584,11 +606,117 @@ void EHBlockDetectorPass::associationAnalysisForErrorHandlers() {
     functionToInErrorNotInErrorPair.clear();
 }
 
+void EHBlockDetectorPass::countCallsOnInspectedPaths(const Function& F, const set<const BasicBlock*>& inspectedBlocks, const set<const BasicBlock*>& errorBlocks) {
+    if (inspectedBlocks.empty())
+        return;
+    for (const auto &BB: F) {
+        if (inspectedBlocks.find(&BB) == inspectedBlocks.end())
+            continue;
+        auto isErrorBlock = errorBlocks.find(&BB) != errorBlocks.end();
+        for (const auto &instruction: BB) {
+            auto calleesIt = getCalleeIteratorForPotentialCallInstruction(*Ctx, instruction);
+            if (calleesIt.has_value()) {
+                for (const auto *target: calleesIt.value()->second) {
+                    if (target->isIntrinsic())
+                        continue;
+                    auto &counts = functionToInErrorNotInErrorPair[target];
+                    if (isErrorBlock) {
+                        ++counts.inError;
+                    } else {
+                        ++counts.notInError;
+                    }
+                }
+            }
+        }
+    }
+}
+
+PathAnalysisOutcome EHBlockDetectorPass::recordPathAnalysisOutcome(const Function& F, const SanityValuesAndConditions& conditions,
+                                                                   const map<const AbstractComparison*, SafetyCheckData>& safetyChecks,
+                                                                   const set<const BasicBlock*>& inspectedBlocks, const set<const BasicBlock*>& errorBlocks,
+                                                                   uint64_t key) {
+    DenseMap<const BasicBlock*, uint32_t> blockIndex;
+    for (const auto& BB : F)
+        blockIndex[&BB] = blockIndex.size();
+
+    PathAnalysisOutcome outcome;
+    outcome.key = key;
+    for (uint32_t i = 0, l = conditions.size(); i < l; ++i) {
+        auto abstractComparison = dyn_cast<AbstractComparison>(conditions[i].second);
+        if (!abstractComparison)
+            continue;
+        auto it = safetyChecks.find(abstractComparison);
+        if (it == safetyChecks.end())
+            continue;
+        const auto& data = it->second;
+        outcome.checks.push_back(PathAnalysisOutcome::Check {
+            .comparisonIndex = i,
+            .lcs = data.lcs,
+            .pathLength = data.pathLength,
+            .sumOfCondBrCount = data.sumOfCondBrCount,
+            .errorHandlingBlock = data.errorHandlingBlock ? blockIndex[data.errorHandlingBlock] : UINT32_MAX,
+        });
+    }
+    for (const auto* BB : inspectedBlocks)
+        outcome.inspectedBlocks.push_back(blockIndex[BB]);
+    for (const auto* BB : errorBlocks)
+        outcome.errorBlocks.push_back(blockIndex[BB]);
+    return outcome;
+}
+
+bool EHBlockDetectorPass::restorePathAnalysisOutcome(const Function& F, const SanityValuesAndConditions& conditions,
+                                                     const PathAnalysisOutcome& outcome,
+                                                     map<const AbstractComparison*, SafetyCheckData>& safetyChecks) {
+    vector<const BasicBlock*> blocks;
+    blocks.reserve(F.size());
+    for (const auto& BB : F)
+        blocks.push_back(&BB);
+
+    // Validate before touching any state, such that a stale entry can still be recomputed
+    auto isBlockValid = [&](uint32_t index) { return index < blocks.size(); };
+    if (!all_of(outcome.checks, [&](const PathAnalysisOutcome::Check& check) {
+            return check.comparisonIndex < conditions.size() && isa<AbstractComparison>(conditions[check.comparisonIndex].second)
+                   && (check.errorHandlingBlock == UINT32_MAX || isBlockValid(check.errorHandlingBlock));
+        }) || !all_of(outcome.inspectedBlocks, isBlockValid) || !all_of(outcome.errorBlocks, isBlockValid))
+        return false;
+
+    for (const auto& [value, conditional] : conditions) {
+        if (!conditional->isFromConditionalBranch()) continue;
+        if (auto abstractComparison = dyn_cast<AbstractComparison>(conditional)) {
+            conditionalToActionLock.lock();
+            conditionalToAction.emplace(abstractComparison, value);
+            conditionalToActionLock.unlock();
+        }
+    }
+
+    for (const auto& check : outcome.checks) {
+        auto& data = safetyChecks[cast<AbstractComparison>(conditions[check.comparisonIndex].second)];
+        data.lcs = check.lcs;
+        data.pathLength = check.pathLength;
+        data.sumOfCondBrCount = check.sumOfCondBrCount;
+        data.errorHandlingBlock = check.errorHandlingBlock == UINT32_MAX ? nullptr : blocks[check.errorHandlingBlock];
+    }
+
+    set<const BasicBlock*> inspectedBlocks, errorBlocks;
+    for (auto index : outcome.inspectedBlocks)
+        inspectedBlocks.insert(blocks[index]);
+    for (auto index : outcome.errorBlocks)
+        errorBlocks.insert(blocks[index]);
+    countCallsOnInspectedPaths(F, inspectedBlocks, errorBlocks);
+    return true;
+}
+
 void EHBlockDetectorPass::stage0(Module* M) {
     auto& safetyChecks = moduleToSafetyChecks.find(M)->second;
 
     auto testCases = getListOfTestCases();
 
+    optional<ModuleAnalysisCache> cache;
+    if (!CacheDirectory.empty()) {
+        if (auto it = Ctx->ModuleContentHashes.find(M); it != Ctx->ModuleContentHashes.end())
+            cache.emplace(CacheDirectory, it->second);
+    }
+
     for (const auto& F : *M) {
         // LOG(LOG_INFO, "Handling " << F.getName() << "\n");
 
@@ -608,6 +736,15 @@ void EHBlockDetectorPass::stage0(Module* M) {
 #if 0
         LOG(LOG_INFO, "# Conditionals of interest: " << functionToSanityCheckCallAndCmpInstructionsIt->second.size() << "\n");
 #endif
+        FunctionProfiler::Scope profile(F, FunctionProfiler::Activity::PathAnalysis);
+
+        uint64_t cacheKey = 0;
+        if (cache) {
+            cacheKey = pathAnalysisKey(F);
+            auto outcome = cache->lookup(F.getName(), cacheKey);
+            if (outcome && restorePathAnalysisOutcome(F, functionToSanityCheckCallAndCmpInstructionsIt->second, *outcome, safetyChecks))
+                continue;
+        }
 
         map<const AbstractComparison*, const vector<const BasicBlock*>*> conditionalToErrorPath;
 
@@ -653,6 +790,8 @@ void EHBlockDetectorPass::stage0(Module* M) {
             }
         }
 
+        FunctionProfiler::count(FunctionProfiler::Work::Paths, paths.size());
+
 #ifdef DUMP_PATHS
         LOG(LOG_INFO, "Paths\n");
         for (const auto* path : paths) {
@@ -702,7 +841,7 @@ void EHBlockDetectorPass::stage0(Module* M) {
                 if (auto I = dyn_cast<Instruction>(pathSummaryIndexToPath[idx]->reason->getOrigin())) {
                     LOG(LOG_INFO, "[origin]  -> ");
                     SourceLocation{I}.dump(LOG_INFO);
-                    I->dump();
+                    OP << *I << "\n";
                 }
                 LOG(LOG_INFO, "Index " << idx << "\n");
                 summary.dump();
@@ -717,7 +856,9 @@ void EHBlockDetectorPass::stage0(Module* M) {
 #endif
 
         auto amountOfSummaries = pathsAsSummaries.size();
+        FunctionProfiler::count(FunctionProfiler::Work::Summaries, amountOfSummaries);
 
+        uint64_t summariesCompared = 0;
         for (size_t i = 0; i < amountOfSummaries; ++i) {
             const auto& pathSummaryI = pathsAsSummaries[i];
             auto numberOfCondBrsI = pathSummaryI.numberOfCondBrs();
@@ -735,6 +876,8 @@ void EHBlockDetectorPass::stage0(Module* M) {
 
                 size_t indicesArray[] { i, j };
                 unsigned short lcs;
+                ++summariesCompared;
+                FunctionProfiler::count(FunctionProfiler::Work::Comparisons);
                 if (isEitherSubsequenceOfTheOther(pathSummaryI.ops, pathSummaryJ.ops, lcs)) {
                     auto sumOfCondBrCount = numberOfCondBrsI + pathSummaryJ.numberOfCondBrs(); // Penalize on number of condbrs
 
@@ -790,6 +933,7 @@ void EHBlockDetectorPass::stage0(Module* M) {
                 }
             }
         }
+        Statistics::SummariesCompared.increment(summariesCompared);
 
         // Register function calls in error paths and not in error paths to perform association analysis
         // First determine the error blocks.
@@ -806,43 +950,30 @@ void EHBlockDetectorPass::stage0(Module* M) {
             }
         }
         // Then count
-        if (!blocksThatAreOnAtLeastOneInspectedPath.empty()) {
-            set<const BasicBlock*> errorBlocks;
-            for (const auto& [reason, path] : conditionalToErrorPath) {
-                // Note: first block is the one that contains the condition, so skip that one as it's not part of the error
-                //       handling code in the path.
-                auto end = path->end();
-                for (auto it = path->begin() + 1; it != end; ++it) {
-                    errorBlocks.insert(*it);
-                }
-            }
-            for (const auto &BB: F) {
-                if (blocksThatAreOnAtLeastOneInspectedPath.find(&BB) == blocksThatAreOnAtLeastOneInspectedPath.end())
-                    continue;
-                auto isErrorBlock = errorBlocks.find(&BB) != errorBlocks.end();
-                for (const auto &instruction: BB) {
-                    auto calleesIt = getCalleeIteratorForPotentialCallInstruction(*Ctx, instruction);
-                    if (calleesIt.has_value()) {
-                        for (const auto *target: calleesIt.value()->second) {
-                            if (target->isIntrinsic())
-                                continue;
-                            auto &counts = functionToInErrorNotInErrorPair[target];
-                            if (isErrorBlock) {
-                                ++counts.inError;
-                            } else {
-                                ++counts.notInError;
-                            }
-                        }
-                    }
-                }
+        set<const BasicBlock*> errorBlocks;
+        for (const auto& [reason, path] : conditionalToErrorPath) {
+            // Note: first block is the one that contains the condition, so skip that one as it's not part of the error
+            //       handling code in the path.
+            auto end = path->end();
+            for (auto it = path->begin() + 1; it != end; ++it) {
+                errorBlocks.insert(*it);
             }
         }
+        countCallsOnInspectedPaths(F, blocksThatAreOnAtLeastOneInspectedPath, errorBlocks);
+
+        if (cache) {
+            cache->store(F.getName(), recordPathAnalysisOutcome(F, functionToSanityCheckCallAndCmpInstructionsIt->second, safetyChecks,
+                                                                blocksThatAreOnAtLeastOneInspectedPath, errorBlocks, cacheKey));
+        }
 
         // Cleanup memory
         for (auto* path : paths)
             delete path;
     }
 
+    if (cache)
+        cache->save();
+
     processSafetyCheckMapping(safetyChecks);
 
     if (ShowSafetyChecks) {
@@ -852,13 +983,26 @@ void EHBlockDetectorPass::stage0(Module* M) {
             LOG(LOG_INFO, "\t");
             SourceLocation{safetyCheckComparison->getOrigin()}.dump(LOG_INFO);
             LOG(LOG_INFO, "\n");
+            if (ReportWriter::isEnabled()) {
+                string condition;
+                raw_string_ostream output(condition);
+                safetyCheckComparison->getLhs()->printAsOperand(output, true);
+                output << " " << CmpInst::getPredicateName(safetyCheckComparison->getPredicate()) << " ";
+                safetyCheckComparison->getRhs()->printAsOperand(output, true);
+                ReportWriter::write("safety-check", "Safety check " + output.str(), ReportWriter::Location::of(safetyCheckComparison->getOrigin()),
+                                    [&](json::OStream& json) {
+                    json.attribute("function", safetyCheckComparison->getOrigin()->getFunction()->getName());
+                    json.attribute("condition", condition);
+                });
+            }
         }
     }
 }
 
 void EHBlockDetectorPass::processSafetyCheckMapping(const map<const AbstractComparison*, SafetyCheckData>& mapping) {
     // Take the union for checks on the same value, and intersect for the targets relating to the values.
-    map<pair<const CallInst*, unsigned int>, Interval> valueToInterval;
+    auto& pool = IntervalPool::get();
+    map<pair<const CallInst*, unsigned int>, IntervalRef> valueToInterval;
     for (const auto& [safetyCheckComparison, safetyCheckData] : mapping) {
         if (!safetyCheckComparison->isFromConditionalBranch()) continue;
         conditionalToActionLock.lock_shared();
@@ -884,9 +1028,9 @@ void EHBlockDetectorPass::processSafetyCheckMapping(const map<const AbstractComp
 
         // Resolve expression to an interval of error values covered by this expression.
         if (rhs.has_value()) {
-            Interval expressionInterval(false);
-            expressionInterval.applyInequalityOperator(predicate, rhs.value());
-            valueToInterval[make_pair(call, pair.second)].unionInPlace(expressionInterval);
+            auto expressionInterval = pool.fromPredicate(predicate, rhs.value());
+            auto& accumulated = valueToInterval.try_emplace(make_pair(call, pair.second), pool.empty()).first->second;
+            accumulated = pool.union_(accumulated, expressionInterval);
         }
     }
     for (const auto& [pair, interval] : valueToInterval) {
@@ -1006,27 +1150,14 @@ optional<bool> EHBlockDetectorPass::determineErrorBranchOfCallWithCompare(ICmpIn
     // Compute the intersection of the intervals for all possible callees
     auto calleesIt = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *checkedCall);
     if (!calleesIt.has_value()) return {};
-    optional<Interval> accumulation;
-    for (const auto *callee: calleesIt.value()->second) {
-        //if (isProbablyPure(callee))
-        //    continue;
-        auto maybeInterval = GlobalCtx.functionErrorReturnIntervals.maybeIntervalFor(make_pair(callee, returnValueIndex));
-        //LOG(LOG_INFO, "Callee: " << callee->getName() << "\n");
-        if (!maybeInterval.has_value()) continue;
-        //maybeInterval.value()->dump();
-        if (accumulation.has_value())
-            accumulation.value().intersectionInPlace(*maybeInterval.value());
-        else
-            accumulation = **maybeInterval;
-    }
+    auto& pool = IntervalPool::get();
+    auto accumulated = GlobalCtx.calleeIntervalCache.get(checkedCall, returnValueIndex, calleesIt.value()->second);
 
     // Only continue if we have a non-empty interval
-    if (!accumulation.has_value() || accumulation.value().empty()) return {};
+    if (!accumulated.anyPresent || accumulated.intersectionOfPresent->empty()) return {};
 
-    Interval predicateInterval(false);
-    predicateInterval.applyInequalityOperator(predicate, rhs);
-    predicateInterval.intersectionInPlace(accumulation.value());
-    bool trueTakenBranchIsAnError = !predicateInterval.empty();
+    auto predicateInterval = pool.intersection(pool.fromPredicate(predicate, rhs), accumulated.intersectionOfPresent);
+    bool trueTakenBranchIsAnError = !predicateInterval->empty();
     return trueTakenBranchIsAnError;
 }
 
@@ -1049,194 +1180,341 @@ static bool returnsOnlyOneConstant(const Function* function) {
 }
 
 /**
- * If we don't yet have error interval information for a function F, learn by doing the following:
- * - Detect basic blocks in F as error blocks if it handles a known error condition from an unmarked safety check
-*/
-void EHBlockDetectorPass::propagateCheckedErrors() {
-    // First, collect the functions that might get a propagation
-    stack<const Function*> functionsThatMightGetAPropagation;
+ * Drives the propagation of learned intervals to callers: starting from the callers of the seeds, a function's outcome
+ * is computed and, if an interval was learned, merged and its callers are queued. Functions are handled in exactly
+ * the order of a serial stack-based worklist, which the results depend on: every function is handled once, with the
+ * intervals of its callees as they are at that point. This is why the functions are not scheduled in waves over the
+ * condensation of the call graph, callees first. That order would hand some callers intervals that the serial order
+ * only learns after them, and so change the results. The verbose log counts these order-dependent outcomes.
+ *
+ * With --speculative-propagation and multiple threads, the next functions on the worklist are computed ahead of time in parallel waves against
+ * the current intervals. When such a function is popped, its precomputed outcome is only committed if none of the
+ * intervals it depended on changed in the meantime, otherwise it is recomputed. This keeps the results identical
+ * to the serial order. Functions of the same module are computed by the same task, because the analysis results
+ * we query are per module and not thread-safe.
+ */
+void EHBlockDetectorPass::propagateThroughCallers(const vector<const Function*>& seeds, const char* name,
+                                                  const function<PropagationOutcome(const Function*)>& compute) {
+    // Used as a stack
+    vector<const Function*> functionsThatMightGetAPropagation;
     set<const Function*> functionsIveAlreadySeen;
 
     auto addCallersToMightPropagateSet = [&](const Function* F) {
         auto callersIt = Ctx->Callers.find(F);
         if (callersIt != Ctx->Callers.end()) {
             for (const auto* call : callersIt->second)
-                functionsThatMightGetAPropagation.emplace(call->getFunction());
+                functionsThatMightGetAPropagation.push_back(call->getFunction());
         }
     };
 
-    for (const auto& [pair, interval] : Ctx->functionErrorReturnIntervals) {
-        if (interval.empty()) continue;
-        auto errorReturningFunction = pair.first;
-        addCallersToMightPropagateSet(errorReturningFunction);
+    for (const auto* seed : seeds) {
+        addCallersToMightPropagateSet(seed);
     }
 
-    unsigned int iterationNumber = 1;
+    struct Speculation {
+        PropagationOutcome outcome;
+        uint64_t computedAtEpoch;
+    };
+    DenseMap<const Function*, Speculation> speculations;
+    unique_ptr<ThreadPool> threadPool;
+    unsigned int waves = 0, speculated = 0, committed = 0, recomputed = 0;
+    // Summed over the waves: the time of all tasks, and the time of the longest task, which bounds the wave's duration
+    chrono::nanoseconds totalWork {0}, totalSpan {0};
+
+    // The range of the worklist scanned by the previous waves, shrunk as the functions are popped
+    size_t scannedBegin = 0, scannedEnd = 0;
+
+    auto runSpeculativeWave = [&]() {
+        // The next distinct functions in pop order that are neither handled nor computed yet. The range of the
+        // worklist scanned by the previous waves holds none of them anymore and is skipped, otherwise the scans grow
+        // quadratic with the worklist.
+        vector<const Function*> candidates;
+        SmallPtrSet<const Function*, 32> candidateSet;
+        size_t windowSize = SpeculationWindowPerThread * ThreadCount;
+        scannedBegin = min(scannedBegin, scannedEnd);
+        size_t index = functionsThatMightGetAPropagation.size();
+        while (index > 0 && candidates.size() < windowSize) {
+            if (index == scannedEnd && scannedBegin < scannedEnd) {
+                index = scannedBegin;
+                continue;
+            }
+            const auto* function = functionsThatMightGetAPropagation[--index];
+            if (functionsIveAlreadySeen.count(function) || speculations.count(function) || !candidateSet.insert(function).second)
+                continue;
+            candidates.push_back(function);
+        }
+        scannedBegin = index;
+        scannedEnd = functionsThatMightGetAPropagation.size();
+
+        MapVector<const Module*, vector<size_t>> candidatesPerModule;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            candidatesPerModule[candidates[i]->getParent()].push_back(i);
+        }
+
+        // The intervals are only read during the wave
+        auto epoch = Ctx->functionErrorReturnIntervals.epoch();
+        vector<PropagationOutcome> outcomes(candidates.size());
+        vector<chrono::nanoseconds> taskTimes(candidatesPerModule.size());
+        if (!threadPool)
+            threadPool = make_unique<ThreadPool>(hardware_concurrency(ThreadCount));
+        Log::flush();
+        size_t task = 0;
+        for (const auto& [_, indices] : candidatesPerModule) {
+            threadPool->async([&, &indices = indices, &taskTime = taskTimes[task++]]() {
+                auto start = chrono::steady_clock::now();
+                for (auto i : indices)
+                    outcomes[i] = compute(candidates[i]);
+                taskTime = chrono::steady_clock::now() - start;
+                Log::flush();
+            });
+        }
+        threadPool->wait();
+        auto work = accumulate(taskTimes.begin(), taskTimes.end(), chrono::nanoseconds {0});
+        auto span = taskTimes.empty() ? chrono::nanoseconds {0} : *max_element(taskTimes.begin(), taskTimes.end());
+        totalWork += work;
+        totalSpan += span;
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            speculations.try_emplace(candidates[i], Speculation {std::move(outcomes[i]), epoch});
+        }
+
+        ++waves;
+        speculated += candidates.size();
+        LOG(LOG_VERBOSE, name << " wave " << waves << ": " << candidates.size() << " functions in "
+                         << candidatesPerModule.size() << " parallel tasks, parallelism "
+                         << format("%.2f", span.count() > 0 ? static_cast<double>(work.count()) / static_cast<double>(span.count()) : 1.0)
+                         << ", worklist " << functionsThatMightGetAPropagation.size() << "\n");
+    };
+
+    auto isStillValid = [&](const Speculation& speculation) {
+        return all_of(speculation.outcome.dependencies, [&](const auto& dependency) {
+            return Ctx->functionErrorReturnIntervals.versionOf(dependency) <= speculation.computedAtEpoch;
+        });
+    };
+
+    // The dependencies of the handled functions and the epoch they were handled at, to count those that depended on an
+    // interval learned afterwards
+    struct Handled {
+        const Function* function;
+        SmallVector<pair<const Function*, unsigned int>, 4> dependencies;
+        uint64_t epoch;
+    };
+    vector<Handled> handled;
+
     while (!functionsThatMightGetAPropagation.empty()) {
-        auto functionThatMightGetAPropagation = functionsThatMightGetAPropagation.top();
-        functionsThatMightGetAPropagation.pop();
+        auto functionThatMightGetAPropagation = functionsThatMightGetAPropagation.back();
+        if (SpeculativePropagation && ThreadCount > 1 && !functionsIveAlreadySeen.count(functionThatMightGetAPropagation) && !speculations.count(functionThatMightGetAPropagation))
+            runSpeculativeWave();
+        functionsThatMightGetAPropagation.pop_back();
+        scannedEnd = min(scannedEnd, functionsThatMightGetAPropagation.size());
         if (!functionsIveAlreadySeen.insert(functionThatMightGetAPropagation).second)
             continue;
 
-        FunctionErrorReturnIntervals newIntervals;
-        //LOG(LOG_INFO, "Function: " << functionThatMightGetAPropagation->getName() << "\n");
-        //if (!function.getName().equals("RSA_blinding_on")) continue;
+        PropagationOutcome outcome;
+        if (auto speculationIt = speculations.find(functionThatMightGetAPropagation); speculationIt != speculations.end()) {
+            if (isStillValid(speculationIt->second)) {
+                outcome = std::move(speculationIt->second.outcome);
+                ++committed;
+            } else {
+                outcome = compute(functionThatMightGetAPropagation);
+                ++recomputed;
+            }
+            speculations.erase(speculationIt);
+        } else {
+            outcome = compute(functionThatMightGetAPropagation);
+        }
 
-        auto functionKeyPair = make_pair(functionThatMightGetAPropagation, 0 /* For now, we only support return values */);
+        if (LOG_ENABLED(LOG_VERBOSE))
+            handled.push_back(Handled {functionThatMightGetAPropagation, outcome.dependencies, Ctx->functionErrorReturnIntervals.epoch()});
 
-        if (functionThatMightGetAPropagation->getReturnType()->isVoidTy())
-            continue;
-        if (Ctx->functionErrorReturnIntervals.maybeIntervalFor(functionKeyPair).has_value())
-            continue;
-        if (returnsOnlyOneConstant(functionKeyPair.first))
-            continue;
+        if (outcome.interval.has_value()) {
+            LOG(LOG_VERBOSE, "Added for: " << functionThatMightGetAPropagation->getName() << " in " << name << "\n");
+            addCallersToMightPropagateSet(functionThatMightGetAPropagation);
 
-        auto& potentialChecks = Ctx->functionToSanityValuesAndConditions.find(functionThatMightGetAPropagation)->second;
-        bool added = false;
-        set<const BasicBlock *> checksBlocks;
-        for (const auto &[valuePair, abstractCondition]: potentialChecks) {
-            checksBlocks.insert(abstractCondition->getParent());
+            FunctionErrorReturnIntervals newIntervals;
+            newIntervals.insertIntervalFor(make_pair(functionThatMightGetAPropagation, 0), std::move(outcome.interval.value()));
+            Ctx->functionErrorReturnIntervals.mergeDestructivelyForOther(newIntervals);
         }
-        for (const auto &[valuePair, abstractCondition]: potentialChecks) {
-            auto abstractComparison = dyn_cast<AbstractComparison>(abstractCondition);
-            if (!abstractComparison) continue;
+    }
 
-            auto [checkedValue, returnValueIndex] = valuePair;
-            auto checkedCall = dyn_cast<CallInst>(checkedValue);
-            if (!checkedCall) continue;
+    if (waves > 0) {
+        LOG(LOG_VERBOSE, name << ": " << waves << " waves, " << speculated << " computed ahead, " << committed
+                         << " committed, " << recomputed << " recomputed, " << speculated - committed - recomputed << " unused, "
+                         << format("%.1f", chrono::duration<double, milli>(totalWork).count()) << " ms of work in a span of "
+                         << format("%.1f", chrono::duration<double, milli>(totalSpan).count()) << " ms\n");
+    }
+    if (LOG_ENABLED(LOG_VERBOSE)) {
+        auto orderDependent = count_if(handled, [&](const Handled& function) {
+            return any_of(function.dependencies, [&](const auto& dependency) {
+                return dependency.first != function.function && Ctx->functionErrorReturnIntervals.versionOf(dependency) > function.epoch;
+            });
+        });
+        LOG(LOG_VERBOSE, name << ": " << handled.size() << " functions handled, " << orderDependent
+                         << " of them before an interval they depend on was learned or changed\n");
+    }
+}
 
-            auto rhs = DataFlowAnalysis::computeRhsFromValue(abstractComparison->getRhs());
-            if (!rhs.has_value()) continue;
+/**
+ * If we don't yet have error interval information for a function F, learn by doing the following:
+ * - Detect basic blocks in F as error blocks if it handles a known error condition from an unmarked safety check
+*/
+EHBlockDetectorPass::PropagationOutcome EHBlockDetectorPass::computeCheckedErrorPropagation(const Function* functionThatMightGetAPropagation) {
+    PropagationOutcome outcome;
+    //LOG(LOG_INFO, "Function: " << functionThatMightGetAPropagation->getName() << "\n");
+    //if (!function.getName().equals("RSA_blinding_on")) continue;
+
+    auto functionKeyPair = make_pair(functionThatMightGetAPropagation, 0u /* For now, we only support return values */);
+
+    if (functionThatMightGetAPropagation->getReturnType()->isVoidTy())
+        return outcome;
+    outcome.dependencies.push_back(functionKeyPair);
+    if (Ctx->functionErrorReturnIntervals.maybeIntervalFor(functionKeyPair).has_value())
+        return outcome;
+    if (returnsOnlyOneConstant(functionKeyPair.first))
+        return outcome;
+
+    auto potentialChecksIt = Ctx->functionToSanityValuesAndConditions.find(functionThatMightGetAPropagation);
+    // A caller without any checks has nothing to propagate
+    if (potentialChecksIt == Ctx->functionToSanityValuesAndConditions.end())
+        return outcome;
+    auto& potentialChecks = potentialChecksIt->second;
+    set<const BasicBlock *> checksBlocks;
+    for (const auto &[valuePair, abstractCondition]: potentialChecks) {
+        checksBlocks.insert(abstractCondition->getParent());
+    }
+    for (const auto &[valuePair, abstractCondition]: potentialChecks) {
+        auto abstractComparison = dyn_cast<AbstractComparison>(abstractCondition);
+        if (!abstractComparison) continue;
 
-            optional<bool> decision = determineErrorBranchOfCallWithCompare(abstractComparison->getPredicate(), returnValueIndex, rhs.value(), checkedCall);
-            if (!decision.has_value())
-                continue;
-            bool trueTakenBranchIsAnError = decision.value();
+        auto [checkedValue, returnValueIndex] = valuePair;
+        auto checkedCall = dyn_cast<CallInst>(checkedValue);
+        if (!checkedCall) continue;
 
-            if (trueTakenBranchIsAnError) {
-                //LOG(LOG_VERBOSE, "is an error\n");
-            } else {
-                //LOG(LOG_VERBOSE, "not an error\n");
-                // NOTE: we can't be sure the non-taken path means non-error, because there could be other error handling in there!
-                continue;
-            }
+        auto rhs = DataFlowAnalysis::computeRhsFromValue(abstractComparison->getRhs());
+        if (!rhs.has_value()) continue;
 
-            // TODO: support switch opcode here
-            if (auto br = dyn_cast<BranchInst>(abstractComparison->getParent()->getTerminator()); br && br->isConditional()) {
-                auto errorBlock = br->getSuccessor(trueTakenBranchIsAnError ? 0 : 1);
-                auto nonErrorBlock = br->getSuccessor(trueTakenBranchIsAnError ? 1 : 0);
-                // NOTE: instead of taking a copy of checksBlocks, just modify it in-place
-                auto didInsertNonErrorBlock = checksBlocks.insert(nonErrorBlock).second;
-
-                vector<Path *> allPaths;
-                Path *myCurrentPath = new Path();
-                myCurrentPath->blocks.push_back(abstractComparison->getParent());
-                allPaths.push_back(myCurrentPath);
-                collectPaths(errorBlock, allPaths, myCurrentPath, checksBlocks);
-
-                if (didInsertNonErrorBlock)
-                    checksBlocks.erase(nonErrorBlock);
-
-                for (auto *path: allPaths) {
-                    auto lastBlock = path->blocks.back();
-                    auto returnInstruction = dyn_cast<ReturnInst>(lastBlock->getTerminator());
-                    // We don't necessarily have a path slice that terminates in a return (think about slices that are cut short due to other checks).
-                    if (returnInstruction) {
-                        auto blocksCopy = extendPathWithUniquePredecessors(path);
-
-                        auto result = addForSpanAndReturnInstruction(PathSpan{blocksCopy, false}, returnInstruction);
-                        if (result.has_value()) {
-                            newIntervals.intervalFor(functionKeyPair, true).unionInPlace(result.value());
-                            added = true;
-                        }
-                    }
+        // The decision depends on the intervals of the callees
+        if (auto calleesIt = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *checkedCall)) {
+            for (const auto* callee : calleesIt.value()->second)
+                outcome.dependencies.emplace_back(callee, returnValueIndex);
+        }
+        optional<bool> decision = determineErrorBranchOfCallWithCompare(abstractComparison->getPredicate(), returnValueIndex, rhs.value(), checkedCall);
+        if (!decision.has_value())
+            continue;
+        bool trueTakenBranchIsAnError = decision.value();
+
+        if (trueTakenBranchIsAnError) {
+            //LOG(LOG_VERBOSE, "is an error\n");
+        } else {
+            //LOG(LOG_VERBOSE, "not an error\n");
+            // NOTE: we can't be sure the non-taken path means non-error, because there could be other error handling in there!
+            continue;
+        }
 
-                    delete path;
+        // TODO: support switch opcode here
+        if (auto br = dyn_cast<BranchInst>(abstractComparison->getParent()->getTerminator()); br && br->isConditional()) {
+            auto errorBlock = br->getSuccessor(trueTakenBranchIsAnError ? 0 : 1);
+            auto nonErrorBlock = br->getSuccessor(trueTakenBranchIsAnError ? 1 : 0);
+            // NOTE: instead of taking a copy of checksBlocks, just modify it in-place
+            auto didInsertNonErrorBlock = checksBlocks.insert(nonErrorBlock).second;
+
+            vector<Path *> allPaths;
+            Path *myCurrentPath = new Path();
+            myCurrentPath->blocks.push_back(abstractComparison->getParent());
+            allPaths.push_back(myCurrentPath);
+            collectPaths(errorBlock, allPaths, myCurrentPath, checksBlocks);
+
+            if (didInsertNonErrorBlock)
+                checksBlocks.erase(nonErrorBlock);
+
+            for (auto *path: allPaths) {
+                auto lastBlock = path->blocks.back();
+                auto returnInstruction = dyn_cast<ReturnInst>(lastBlock->getTerminator());
+                // We don't necessarily have a path slice that terminates in a return (think about slices that are cut short due to other checks).
+                if (returnInstruction) {
+                    auto blocksCopy = extendPathWithUniquePredecessors(path);
+
+                    auto result = addForSpanAndReturnInstruction(PathSpan{blocksCopy, false}, returnInstruction);
+                    if (result.has_value()) {
+                        if (!outcome.interval.has_value())
+                            outcome.interval = Interval(true);
+                        outcome.interval.value().unionInPlace(result.value());
+                    }
                 }
+
+                delete path;
             }
-            //newIntervals.dump();
         }
+    }
 
-        if (added) {
-            LOG(LOG_VERBOSE, "Added for: " << functionThatMightGetAPropagation->getName() << " in " << __FUNCTION__ << "\n");
-            addCallersToMightPropagateSet(functionThatMightGetAPropagation);
-        }
+    return outcome;
+}
 
-        //newIntervals.dump();
-        //LOG(LOG_INFO, "Completed successful iteration number " << iterationNumber << "\n");
-        Ctx->functionErrorReturnIntervals.mergeDestructivelyForOther(newIntervals);
-        ++iterationNumber;
+void EHBlockDetectorPass::propagateCheckedErrors() {
+    // First, collect the functions that might get a propagation
+    vector<const Function*> errorReturningFunctions;
+    for (const auto& [pair, interval] : Ctx->functionErrorReturnIntervals) {
+        if (interval.empty()) continue;
+        errorReturningFunctions.push_back(pair.first);
     }
+
+    propagateThroughCallers(errorReturningFunctions, __FUNCTION__, [this](const Function* function) {
+        return computeCheckedErrorPropagation(function);
+    });
 }
 
 /**
  * If we don't yet have error interval information for a function F, learn by doing the following:
  * - Detects basic blocks in F as error blocks if it calls typical error (a) handling function(s), which is similar
  *   to stage 1, except that in this case we're learning about F and not the function that gets called.
+ * This does not depend on any learned interval.
  */
-void EHBlockDetectorPass::learnErrorsFromErrorBlocksForSelf() {
-    // First, collect the functions that might get a propagation
-    stack<const Function*> functionsThatMightGetAPropagation;
-    set<const Function*> functionsIveAlreadySeen;
-
-    auto addCallersToMightPropagateSet = [&](const Function* F) {
-        auto callersIt = Ctx->Callers.find(F);
-        if (callersIt != Ctx->Callers.end()) {
-            for (const auto* call : callersIt->second)
-                functionsThatMightGetAPropagation.emplace(call->getFunction());
-        }
-    };
-
-    for (const auto* associatedErrorHandlerFunction : associatedErrorHandlerFunctions) {
-        addCallersToMightPropagateSet(associatedErrorHandlerFunction);
-    }
+EHBlockDetectorPass::PropagationOutcome EHBlockDetectorPass::computeErrorsFromErrorBlocksForSelf(const Function* functionThatMightGetAPropagation) {
+    PropagationOutcome outcome;
 
-    unsigned int iterationNumber = 1;
-    while (!functionsThatMightGetAPropagation.empty()) {
-        auto functionThatMightGetAPropagation = functionsThatMightGetAPropagation.top();
-        functionsThatMightGetAPropagation.pop();
-        if (!functionsIveAlreadySeen.insert(functionThatMightGetAPropagation).second)
-            continue;
+    if (functionThatMightGetAPropagation->getReturnType()->isVoidTy())
+        return outcome;
+    if (returnsOnlyOneConstant(functionThatMightGetAPropagation))
+        return outcome;
 
-        FunctionErrorReturnIntervals newIntervals;
+    //LOG(LOG_INFO, "learnErrorsFromErrorBlocksForSelf: " << functionThatMightGetAPropagation->getName() << "\n");
 
-        auto functionKeyPair = make_pair(functionThatMightGetAPropagation, 0);
-
-        if (functionThatMightGetAPropagation->getReturnType()->isVoidTy())
-            continue;
-        if (returnsOnlyOneConstant(functionKeyPair.first))
-            continue;
-
-        //LOG(LOG_INFO, "learnErrorsFromErrorBlocksForSelf: " << functionThatMightGetAPropagation->getName() << "\n");
-
-        bool added = false;
-        for (const auto& BB : *functionThatMightGetAPropagation) {
-            // NOTE: don't check for amount of successors, because of certain fallthrough path constructions
-            auto errorHandlingBlock = determineSuccessorOfAbstractComparisonWhichHandlesErrors(&BB);
-            if (!errorHandlingBlock) continue;
-            vector<const BasicBlock*> blocks;
-            DataFlowAnalysis::getLinearUniquePathForwards(errorHandlingBlock, blocks);
-            auto returnInstruction = dyn_cast<ReturnInst>(blocks.back()->getTerminator());
-            // We don't necessarily have a path slice that terminates in a return (think about slices that are cut short due to other checks).
-            if (!returnInstruction) continue;
-            auto result = addForSpanAndReturnInstruction(PathSpan{blocks, false}, returnInstruction);
-            if (result.has_value()) {
-                newIntervals.intervalFor(functionKeyPair, true).unionInPlace(result.value());
-                added = true;
-            }
+    for (const auto& BB : *functionThatMightGetAPropagation) {
+        // NOTE: don't check for amount of successors, because of certain fallthrough path constructions
+        auto errorHandlingBlock = determineSuccessorOfAbstractComparisonWhichHandlesErrors(&BB);
+        if (!errorHandlingBlock) continue;
+        vector<const BasicBlock*> blocks;
+        DataFlowAnalysis::getLinearUniquePathForwards(errorHandlingBlock, blocks);
+        auto returnInstruction = dyn_cast<ReturnInst>(blocks.back()->getTerminator());
+        // We don't necessarily have a path slice that terminates in a return (think about slices that are cut short due to other checks).
+        if (!returnInstruction) continue;
+        auto result = addForSpanAndReturnInstruction(PathSpan{blocks, false}, returnInstruction);
+        if (result.has_value()) {
+            if (!outcome.interval.has_value())
+                outcome.interval = Interval(true);
+            outcome.interval.value().unionInPlace(result.value());
         }
+    }
 
-        if (added) {
-            LOG(LOG_VERBOSE, "Added for: " << functionThatMightGetAPropagation->getName() << " in " << __FUNCTION__ << "\n");
-            addCallersToMightPropagateSet(functionThatMightGetAPropagation);
-            //newIntervals.dump();
-        }
+    return outcome;
+}
 
-        //newIntervals.dump();
-        //LOG(LOG_INFO, "Completed successful iteration number " << iterationNumber << "\n");
-        Ctx->functionErrorReturnIntervals.mergeDestructivelyForOther(newIntervals);
-        ++iterationNumber;
-    }
+void EHBlockDetectorPass::learnErrorsFromErrorBlocksForSelf() {
+    vector<const Function*> seeds(associatedErrorHandlerFunctions.begin(), associatedErrorHandlerFunctions.end());
+    propagateThroughCallers(seeds, __FUNCTION__, [this](const Function* function) {
+        return computeErrorsFromErrorBlocksForSelf(function);
+    });
+}
+
+void EHBlockDetectorPass::accountMemory(MemoryAccounting::MemoryReport& report) const {
+    report.add("EHBlockDetectorPass::functionToInErrorNotInErrorPair", functionToInErrorNotInErrorPair);
+    report.add("EHBlockDetectorPass::functionToIntervalCounts", functionToIntervalCounts);
+    size_t safetyChecks = 0;
+    for (const auto& [module, checks] : moduleToSafetyChecks)
+        safetyChecks += checks.size();
+    report.add("EHBlockDetectorPass::moduleToSafetyChecks", safetyChecks, MemoryAccounting::approximateBytes(moduleToSafetyChecks));
+    report.add("EHBlockDetectorPass::conditionalToAction", conditionalToAction);
+    report.add("EHBlockDetectorPass::associatedErrorHandlerFunctions", associatedErrorHandlerFunctions);
 }
 
 void EHBlockDetectorPass::doModulePass(Module *M) {
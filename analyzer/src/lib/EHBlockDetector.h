@@ -1,8 +1,11 @@
 #pragma once
 
+#include "AnalysisCache.h"
 #include "Analyzer.h"
 #include "Common.h"
+#include "MemoryAccounting.h"
 #include "PathSpan.h"
+#include <functional>
 #include <shared_mutex>
 
 
@@ -64,6 +67,28 @@ struct Summary {
     void dump() const;
 };
 
+// Whether the shorter of the two sequences is a subsequence of the longer one, lcsOut is set to the length of the shorter one.
+template<typename T>
+bool isEitherSubsequenceOfTheOther(const vector<T> &aVec, const vector<T> &bVec, unsigned short &lcsOut) {
+    // Shortest one should be in a
+    span<const T> a = aVec, b = bVec;
+    if (a.size() > b.size()) {
+        swap(a, b);
+    }
+
+    size_t aIdx = 0;
+    size_t diff = b.size() - a.size(); // >= 0 because |a| <= |b|
+    // Note: aIdx <= bIdx
+    for (size_t bIdx = 0; aIdx < a.size() && diff >= bIdx - aIdx /* checks if remaining for b >= remaining for a */; ++bIdx) {
+        if (a[aIdx] == b[bIdx]) {
+            ++aIdx;
+        }
+    }
+
+    lcsOut = a.size();
+    return aIdx == a.size();
+}
+
 struct SafetyCheckData {
     unsigned short lcs {};
     unsigned short pathLength {numeric_limits<unsigned short>::max()};
@@ -79,6 +104,11 @@ public:
             : IterativeModulePass(Ctx_, "EHBlockDetector") {
     }
     bool doInitialization(llvm::Module *) override;
+    // The two halves of the initialization, resuming from a checkpoint only needs the second one for the functions whose checks were not stored
+    void initializeAliasAnalysis(llvm::Module *);
+    void collectPotentialSanityChecks(const Function& function);
+    [[nodiscard]] bool initializesConcurrently() const override { return true; }
+    void run(const std::vector<llvm::Module *> &modules, bool multithreaded) override;
     bool doFinalization(llvm::Module *) override;
     void doModulePass(llvm::Module *) override;
     void associationAnalysisForErrorHandlers();
@@ -86,17 +116,40 @@ public:
     inline void nextStage() { stage++; }
     void propagateCheckedErrors();
     void learnErrorsFromErrorBlocksForSelf();
+    void accountMemory(MemoryAccounting::MemoryReport& report) const;
 
     static void collectPaths(const BasicBlock* currentBlock, vector<Path*>& allPaths, Path* myCurrentPath, set<const BasicBlock*>& basicBlocksOfNonInterest);
     static optional<bool> determineErrorBranchOfCallWithCompare(ICmpInst::Predicate predicate, unsigned int returnValueIndex, int rhs, const CallInst* checkedCall);
 
 private:
+    // Interval learned for a function by propagation, and the intervals that this was derived from.
+    struct PropagationOutcome {
+        optional<Interval> interval;
+        SmallVector<pair<const Function*, unsigned int>, 4> dependencies;
+    };
+
+    // Amount of functions computed ahead per thread in a propagation wave
+    static constexpr size_t SpeculationWindowPerThread = 32;
+
+    void propagateThroughCallers(const vector<const Function*>& seeds, const char* name, const function<PropagationOutcome(const Function*)>& compute);
+    PropagationOutcome computeCheckedErrorPropagation(const Function* function);
+    PropagationOutcome computeErrorsFromErrorBlocksForSelf(const Function* function);
+
+    using SanityValuesAndConditions = vector<pair<pair<const Value*, unsigned int>, const AbstractCondition*>>;
+
     void stage0(llvm::Module *);
+    void countCallsOnInspectedPaths(const Function& F, const set<const BasicBlock*>& inspectedBlocks, const set<const BasicBlock*>& errorBlocks);
+    static PathAnalysisOutcome recordPathAnalysisOutcome(const Function& F, const SanityValuesAndConditions& conditions,
+                                                         const map<const AbstractComparison*, SafetyCheckData>& safetyChecks,
+                                                         const set<const BasicBlock*>& inspectedBlocks, const set<const BasicBlock*>& errorBlocks,
+                                                         uint64_t key);
+    bool restorePathAnalysisOutcome(const Function& F, const SanityValuesAndConditions& conditions, const PathAnalysisOutcome& outcome,
+                                    map<const AbstractComparison*, SafetyCheckData>& safetyChecks);
     void stage1(llvm::Module *);
     void processSafetyCheckMapping(const map<const AbstractComparison*, SafetyCheckData>& mapping);
 
     Summary summarizeBlock(const BasicBlock* currentBlock) const;
-    void identifyPotentialSanityChecks(const Function& function);
+    void identifyPotentialSanityChecks(const Function& function, SanityValuesAndConditions& out) const;
     static void collectPathsAux(const BasicBlock* currentBlock, vector<Path*>& allPaths, Path* myCurrentPath, set<const BasicBlock*>& visited, set<const BasicBlock*>& basicBlocksOfNonInterest, const BasicBlock* lastBr);
     const BasicBlock* determineSuccessorOfAbstractComparisonWhichHandlesErrors(const AbstractComparison* abstractComparison) const;
     const BasicBlock* determineSuccessorOfAbstractComparisonWhichHandlesErrors(const BasicBlock* abstractComparisonBlock) const;
@@ -105,6 +158,7 @@ private:
     map<const Function*, InErrorNotInErrorPair> functionToInErrorNotInErrorPair;
     FunctionToIntervalCounts functionToIntervalCounts;
     map<const Module*, map<const AbstractComparison*, SafetyCheckData>> moduleToSafetyChecks;
+    mutex sanityValuesAndConditionsLock;
     shared_mutex conditionalToActionLock;
     map<const AbstractComparison*, pair<const Value*, unsigned int>> conditionalToAction;
     set<const Function*> associatedErrorHandlerFunctions;
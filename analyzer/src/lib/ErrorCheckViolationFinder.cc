@@ -6,6 +6,9 @@
 #include <llvm/Analysis/CallGraph.h>
 #include <llvm/IR/IntrinsicInst.h>
 #include <sys/wait.h>
+#include <chrono>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
 
 #include "EHBlockDetector.h"
 #include "ErrorCheckViolationFinder.h"
@@ -15,6 +18,8 @@
 #include "ClOptForward.h"
 #include "Helpers.h"
 #include "DebugHelpers.h"
+#include "FunctionProfiler.h"
+#include "ReportWriter.h"
 
 //#define NO_INLINE_COUNTING_INCORRECT
 #define NO_INLINE_COUNTING_MISSING
@@ -30,6 +35,15 @@ bool ErrorCheckViolationFinderPass::doFinalization(Module *M) {
     return false;
 }
 
+void ErrorCheckViolationFinderPass::nextStage() {
+    stage++;
+    // Only stage 0 examines functions for missing checks and propagation
+    if (stage == 1)
+        functionExaminations = {};
+    if (stage == 1 && ProgressiveReport)
+        prepareProgressiveReport();
+}
+
 void ErrorCheckViolationFinderPass::finish() {
     // Show learned rules for inspection by user and report bugs.
     Ctx->functionErrorReturnIntervals.dump();
@@ -38,6 +52,7 @@ void ErrorCheckViolationFinderPass::finish() {
 
 void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(const Function& function, const FunctionErrorReturnIntervals& inputErrorIntervals, FunctionErrorReturnIntervals& outputErrorIntervals, set<const Function*>& functionsToInspectNext, unordered_set<uintptr_t>& handledFunctionPairs, map<pair<const Function*, unsigned int>, Interval>& replaceMap) {
     LOG(LOG_VERBOSE, "determineMissingChecksAndPropagationRules: " << function.getName() << "\n");
+    FunctionProfiler::Scope profile(function, FunctionProfiler::Activity::MissingChecks);
 
     // 1) collect all call instructions into a set "instSet"
     // 2) collect the compare instructions and use the same DFA as in the rule derivation to find out what the corresponding call is (if any)
@@ -45,17 +60,34 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
     // 2.2) remove the instruction from "instSet"
     // 3) report all cases that are still left in "instSet"
 
+    auto& examination = examinationFor(function);
+
+    // Nothing this examination depends on changed since the last time: the outcome is the same.
+    // Reports are not repeated anyway (see visited), so only the propagation results need to be replayed.
+    if (isExaminationUpToDate(function, examination, inputErrorIntervals)) {
+        ++examinationsReplayed;
+        if (examination.insertedInterval.has_value()) {
+            Interval interval = examination.insertedInterval.value();
+            outputErrorIntervals.insertIntervalFor(make_pair(&function, 0), std::move(interval));
+        }
+        if (examination.notifiedCallers)
+            notifyCallersOfPropagation(function, functionsToInspectNext, handledFunctionPairs);
+        return;
+    }
+    examination.examined = true;
+    examination.examinedAtEpoch = inputErrorIntervals.epoch();
+    examination.examinedAtConfidenceEpoch = confidenceEpoch;
+    examination.replaced = false;
+    examination.notifiedCallers = false;
+    examination.insertedInterval.reset();
+
     set<const Value*> instSet;
-    set<const ICmpInst*> comparisons;
-    for (const auto& instruction : instructions(function)) {
-        auto maybeCallees = getCalleeIteratorForPotentialCallInstruction(*Ctx, instruction);
-        if (maybeCallees.has_value()) {
-            if (any_of(maybeCallees.value()->second, [&](const Function* target) {
-                auto maybeInterval = inputErrorIntervals.maybeIntervalFor(make_pair(target, 0));
-                return maybeInterval.has_value() && !maybeInterval.value()->empty();
-            })) {
-                instSet.insert(maybeCallees.value()->getFirst());
-            }
+    for (const auto& [call, callees] : examination.calls) {
+        if (any_of(*callees, [&](const Function* target) {
+            auto maybeInterval = inputErrorIntervals.maybeIntervalFor(make_pair(target, 0));
+            return maybeInterval.has_value() && !maybeInterval.value()->empty();
+        })) {
+            instSet.insert(call);
         }
     }
 
@@ -97,30 +129,21 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
                 }
             }
 
-            // Collect paths starting from this call instruction to the end(s) of the function.
-            // We can use collectPaths for this with basicBlocksOfNonInterest == {}
-            set<const BasicBlock*> emptySet;
-            Path* myCurrentPath = new Path();
-            vector<Path*> allPaths;
-            allPaths.push_back(myCurrentPath);
-            EHBlockDetectorPass::collectPaths(root, allPaths, myCurrentPath, emptySet);
-
-            for (auto* path : allPaths) {
-                auto lastBB = path->blocks.back();
-                if (auto ret = dyn_cast<ReturnInst>(lastBB->getTerminator())) {
+            for (const auto& resolvedReturn : resolvedReturnsFor(examination, root)) {
+                auto ret = resolvedReturn.ret;
+                {
                     auto returnValueIndex = 0; // Only return values supported right now
 
-                    PHISet phiSet;
-                    if (auto resolvedValue = DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(ret->getReturnValue(), ret, PathSpan{path->blocks, false}, phiSet)) {
+                    if (auto resolvedValue = resolvedReturn.resolvedValue) {
                         instSet.erase(dyn_cast<Instruction>(resolvedValue));
                         // Handle the case where we get a cmp first instead of a call
                         if (auto cmp = dyn_cast<ICmpInst>(resolvedValue)) {
 #if 1
-                            resolvedValue = DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(cmp->getOperand(0), cmp, PathSpan{path->blocks, false}, phiSet);
+                            resolvedValue = resolvedReturn.comparedValue;
                             if (!resolvedValue) continue;
                             auto checkedCall = dyn_cast<CallInst>(resolvedValue);
                             if (!checkedCall) continue;
-                            auto rhs = DataFlowAnalysis::computeRhsFromValue(cmp->getOperand(1));
+                            auto rhs = resolvedReturn.rhs;
                             if (!rhs.has_value()) continue;
                             optional<bool> trueTakenBranchIsErrorOpt = EHBlockDetectorPass::determineErrorBranchOfCallWithCompare(cmp->getPredicate(), returnValueIndex, rhs.value(), checkedCall);
                             if (!trueTakenBranchIsErrorOpt.has_value()) continue;
@@ -168,10 +191,6 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
                     }
                 }
             }
-
-            // Cleanup memory
-            for (auto* path : allPaths)
-                delete path;
         }
 
         if (!thisFunctionInterval.empty() && !thisFunctionInterval.full()) {
@@ -241,21 +260,19 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
                 if (edit) {
                     /*if (intersection.empty() || oldInterval.value()->size() > thisFunctionInterval.size()) */{
                         Ctx->functionToConfidence[functionPair] = avgNewConfidence;
+                        ++confidenceEpoch;
+                        examination.replaced = true;
                         replaceMap.emplace(functionPair, std::move(thisFunctionInterval));
                     }
                 }
             } else {
+                examination.insertedInterval = thisFunctionInterval;
                 outputErrorIntervals.insertIntervalFor(functionPair, std::move(thisFunctionInterval));
             }
 
             // The functions that must be inspected are the callers.
-            if (auto callersIt = Ctx->Callers.find(&function); callersIt != Ctx->Callers.end()) {
-                for (const auto* caller : callersIt->second) {
-                    auto key = reinterpret_cast<uintptr_t>(caller->getFunction()) ^ reinterpret_cast<uintptr_t>(&function);
-                    if (handledFunctionPairs.insert(key).second)
-                        functionsToInspectNext.insert(caller->getFunction());
-                }
-            }
+            examination.notifiedCallers = true;
+            notifyCallersOfPropagation(function, functionsToInspectNext, handledFunctionPairs);
         }
     }
 
@@ -270,21 +287,25 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
     if (!instSet.empty()) {
 #ifdef REPORT
         // LOG(LOG_INFO, "Unhandled error checks:\n");
-        set<const Value*> result;
-        for (const auto& instruction : instructions(function)) {
-            set<const Value*> visited;
-            if (isa<ICmpInst>(instruction)) {
-                DataFlowAnalysis::collectCalls(instruction.getOperand(0), visited, result);
-            } else if (auto br = dyn_cast<BranchInst>(&instruction)) {
-                if (br->isConditional()) {
-                    DataFlowAnalysis::collectCalls(br->getCondition(), visited, result);
-                }
-            } else if (auto ret = dyn_cast<ReturnInst>(&instruction)) {
-                if (ret->getReturnValue()) {
-                    DataFlowAnalysis::collectCalls(ret->getReturnValue(), visited, result);
+        if (!examination.collectedCalls.has_value()) {
+            set<const Value*> result;
+            for (const auto& instruction : instructions(function)) {
+                set<const Value*> visited;
+                if (isa<ICmpInst>(instruction)) {
+                    DataFlowAnalysis::collectCalls(instruction.getOperand(0), visited, result);
+                } else if (auto br = dyn_cast<BranchInst>(&instruction)) {
+                    if (br->isConditional()) {
+                        DataFlowAnalysis::collectCalls(br->getCondition(), visited, result);
+                    }
+                } else if (auto ret = dyn_cast<ReturnInst>(&instruction)) {
+                    if (ret->getReturnValue()) {
+                        DataFlowAnalysis::collectCalls(ret->getReturnValue(), visited, result);
+                    }
                 }
             }
+            examination.collectedCalls = std::move(result);
         }
+        const auto& result = examination.collectedCalls.value();
 
         for (const auto* value : instSet) {
             if (value->getType()->isPointerTy() && !(any_of(value->users(), [](const Value* user) {
@@ -338,6 +359,84 @@ void ErrorCheckViolationFinderPass::determineMissingChecksAndPropagationRules(co
     }
 }
 
+ErrorCheckViolationFinderPass::FunctionExamination& ErrorCheckViolationFinderPass::examinationFor(const Function& function) {
+    auto& examination = functionExaminations[&function];
+    if (!examination.callsCollected) {
+        examination.callsCollected = true;
+        DenseSet<const Function*> dependencies;
+        for (const auto& instruction : instructions(function)) {
+            auto maybeCallees = getCalleeIteratorForPotentialCallInstruction(*Ctx, instruction);
+            if (maybeCallees.has_value()) {
+                examination.calls.emplace_back(maybeCallees.value()->getFirst(), &maybeCallees.value()->second);
+                for (const auto* target : maybeCallees.value()->second) {
+                    if (dependencies.insert(target).second)
+                        examination.dependencies.push_back(target);
+                }
+            }
+        }
+    }
+    return examination;
+}
+
+const vector<ErrorCheckViolationFinderPass::ResolvedReturn>& ErrorCheckViolationFinderPass::resolvedReturnsFor(FunctionExamination& examination, const BasicBlock* root) {
+    auto [it, inserted] = examination.resolvedReturnsForRoot.try_emplace(root);
+    if (!inserted)
+        return it->second;
+
+    // Collect paths starting from this call instruction to the end(s) of the function.
+    // We can use collectPaths for this with basicBlocksOfNonInterest == {}
+    set<const BasicBlock*> emptySet;
+    Path* myCurrentPath = new Path();
+    vector<Path*> allPaths;
+    allPaths.push_back(myCurrentPath);
+    EHBlockDetectorPass::collectPaths(root, allPaths, myCurrentPath, emptySet);
+
+    for (auto* path : allPaths) {
+        auto lastBB = path->blocks.back();
+        if (auto ret = dyn_cast<ReturnInst>(lastBB->getTerminator())) {
+            ResolvedReturn resolvedReturn {ret, nullptr, nullptr, {}};
+            PHISet phiSet;
+            FunctionProfiler::count(FunctionProfiler::Work::Resolutions);
+            resolvedReturn.resolvedValue = DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(ret->getReturnValue(), ret, PathSpan{path->blocks, false}, phiSet);
+            if (auto cmp = dyn_cast_or_null<ICmpInst>(resolvedReturn.resolvedValue)) {
+                resolvedReturn.comparedValue = DataFlowAnalysis::findUndisputedValueWithoutLeavingCurrentPath(cmp->getOperand(0), cmp, PathSpan{path->blocks, false}, phiSet);
+                resolvedReturn.rhs = DataFlowAnalysis::computeRhsFromValue(cmp->getOperand(1));
+            }
+            it->second.push_back(resolvedReturn);
+        }
+    }
+
+    // Cleanup memory
+    for (auto* path : allPaths)
+        delete path;
+
+    return it->second;
+}
+
+bool ErrorCheckViolationFinderPass::isExaminationUpToDate(const Function& function, const FunctionExamination& examination, const FunctionErrorReturnIntervals& inputErrorIntervals) const {
+    // A replacement changes our own interval and confidence, so it never stays up to date
+    if (!examination.examined || examination.replaced || examination.examinedAtConfidenceEpoch != confidenceEpoch)
+        return false;
+    auto epoch = examination.examinedAtEpoch;
+    if (inputErrorIntervals.epoch() == epoch)
+        return true;
+    if (inputErrorIntervals.versionOf(make_pair(&function, 0)) > epoch)
+        return false;
+    return all_of(examination.dependencies, [&](const Function* dependency) {
+        return inputErrorIntervals.versionOf(make_pair(dependency, 0)) <= epoch;
+    });
+}
+
+void ErrorCheckViolationFinderPass::notifyCallersOfPropagation(const Function& function, set<const Function*>& functionsToInspectNext, unordered_set<uintptr_t>& handledFunctionPairs) {
+    if (auto callersIt = Ctx->Callers.find(&function); callersIt != Ctx->Callers.end()) {
+        for (const auto* caller : callersIt->second) {
+            auto key = reinterpret_cast<uintptr_t>(caller->getFunction()) ^ reinterpret_cast<uintptr_t>(&function);
+            if (handledFunctionPairs.insert(key).second)
+                functionsToInspectNext.insert(caller->getFunction());
+        }
+    }
+}
+
 void ErrorCheckViolationFinderPass::determineIncorrectChecks(const Function& function) {
 #ifndef REPORT
     return;
@@ -375,12 +474,9 @@ void ErrorCheckViolationFinderPass::determineIncorrectChecks(const Function& fun
         auto check = [&](const Interval& comparisonInterval) {
             auto calleesIt = Ctx->Callees.find(call);
             if (calleesIt != Ctx->Callees.end()) {
-                return all_of(calleesIt->second, [&](const Function* target) {
-                    auto maybeInterval = Ctx->functionErrorReturnIntervals.maybeIntervalFor(make_pair(target, valueIndex));
-                    if (!maybeInterval.has_value() || maybeInterval.value()->empty() || maybeInterval.value()->full())
-                        return true;
-                    return maybeInterval.value()->isSubsetOf(comparisonInterval);
-                });
+                // Every non-trivial callee interval is a subset iff their union is
+                auto accumulated = Ctx->calleeIntervalCache.get(call, valueIndex, calleesIt->second);
+                return accumulated.unionOfNonEmptyNonFull->isSubsetOf(comparisonInterval);
             }
             return true; // It's fine
         };
@@ -413,10 +509,13 @@ void ErrorCheckViolationFinderPass::determineIncorrectChecks(const Function& fun
                 }
             }
 #endif
-            incorrectErrorReports[SourceLocation{call, false}].emplace_back(IncorrectCheckErrorReport {
+            auto [locationIt, inserted] = incorrectErrorReports.try_emplace(SourceLocation{call, false});
+            locationIt->second.emplace_back(IncorrectCheckErrorReport {
                 .intervals = std::move(intervals),
                 .call = call,
             });
+            if (inserted && ProgressiveReport)
+                newReportLocations.push_back(&*locationIt);
 
 #ifdef NO_INLINE_COUNTING_INCORRECT
             if (!(call->getDebugLoc().get() && call->getDebugLoc().getInlinedAt())) {
@@ -431,7 +530,7 @@ void ErrorCheckViolationFinderPass::determineIncorrectChecks(const Function& fun
                         data.incorrect++;
 #ifdef DEBUG_STORING_REPORT_DATA
                         LOG(LOG_INFO, "Total++, Incorrect++ for " << callee->getName() << "\n");
-                        call->dump();
+                        OP << *call << "\n";
 #endif
                     }
                 }
@@ -440,106 +539,252 @@ void ErrorCheckViolationFinderPass::determineIncorrectChecks(const Function& fun
     }
 }
 
+vector<const ErrorCheckViolationFinderPass::ReportMap::value_type*> ErrorCheckViolationFinderPass::reportLocationsInSourceOrder() const {
+    vector<const ReportMap::value_type*> locationsAndReports;
+    vector<const SourceLocation*> locations;
+    locationsAndReports.reserve(incorrectErrorReports.size());
+    locations.reserve(incorrectErrorReports.size());
+    for (const auto& locationAndReports : incorrectErrorReports) {
+        locationsAndReports.push_back(&locationAndReports);
+        locations.push_back(&locationAndReports.first);
+    }
+    vector<const ReportMap::value_type*> sorted;
+    sorted.reserve(locationsAndReports.size());
+    for (auto index : SourceLocation::sourceOrder(locations))
+        sorted.push_back(locationsAndReports[index]);
+    return sorted;
+}
+
 void ErrorCheckViolationFinderPass::report() const {
-    for (const auto& [baseLocation, reports] : incorrectErrorReports) {
-        auto call = reports[0].call;
-        //SourceLocation callSourceLocation{call};
+    vector<ScoredReport> scoredReports = progressiveScoredReports;
+    for (const auto* locationAndReports : reportLocationsInSourceOrder()) {
+        const auto& [baseLocation, reports] = *locationAndReports;
+        if (!progressivelyReported.count(&baseLocation))
+            reportLocation(baseLocation, reports, scoredReports);
+    }
 
-        if (!baseLocation.isValidProgramSource())
-            continue;
+    if (!ReportCandidatesFile.empty() || !SweepMissingThresholds.empty()) {
+        // The progressive reports are emitted in the order the callees were finished in
+        vector<const SourceLocation*> locations;
+        locations.reserve(scoredReports.size());
+        for (const auto& scoredReport : scoredReports)
+            locations.push_back(scoredReport.location);
+        vector<ScoredReport> sorted;
+        sorted.reserve(scoredReports.size());
+        for (auto index : SourceLocation::sourceOrder(locations))
+            sorted.push_back(std::move(scoredReports[index]));
+        writeScoredReports(sorted);
+    }
+}
 
-        bool isIncorrectCase = reports[0].intervals.has_value();
+void ErrorCheckViolationFinderPass::reportLocation(const SourceLocation& baseLocation, const vector<IncorrectCheckErrorReport>& reports, vector<ScoredReport>& scoredReports) const {
+    auto call = reports[0].call;
+    //SourceLocation callSourceLocation{call};
 
-        CountPair sum;
-        float amount = 0.0f;
-        if (auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *call)) {
-            // If a function is pure, its result is purely dependent on the input and thus should be handled in a context-sensitive way.
-            if (all_of(callees.value()->second, isProbablyPure)) {
-                continue;
-            }
+    if (!baseLocation.isValidProgramSource())
+        return;
 
-            auto &counts = errorFunctionToCountPairsFor(isIncorrectCase ? CountPairType::Incorrect : CountPairType::Missing);
-            for (const auto *callee: callees.value()->second) {
-                sum = sum + counts.find(callee)->second;
-                amount++;
-            }
+    bool isIncorrectCase = reports[0].intervals.has_value();
+
+    CountPair sum;
+    float amount = 0.0f;
+    if (auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *call)) {
+        // If a function is pure, its result is purely dependent on the input and thus should be handled in a context-sensitive way.
+        if (all_of(callees.value()->second, isProbablyPure)) {
+            return;
+        }
+
+        auto &counts = errorFunctionToCountPairsFor(isIncorrectCase ? CountPairType::Incorrect : CountPairType::Missing);
+        for (const auto *callee: callees.value()->second) {
+            sum = sum + counts.find(callee)->second;
+            amount++;
         }
+    }
 
 #if 1
-        sum.incorrect /= amount;
-        sum.total /= amount;
+    sum.incorrect /= amount;
+    sum.total /= amount;
 #endif
-        float score = wilsonScore(sum.total - sum.incorrect, sum.total, 1.645f /* Z for 90% confidence interval */);
+    float score = wilsonScore(sum.total - sum.incorrect, sum.total, 1.645f /* Z for 90% confidence interval */);
 
-        bool filter = score < (isIncorrectCase ? IncorrectCheckThreshold :MissingCheckThreshold);
-        unsigned int logLevel = LOG_INFO;
-        if (filter) {
-            LOG(LOG_VERBOSE, "Skip: ");
-            logLevel = LOG_VERBOSE;
+    bool filter = score < (isIncorrectCase ? IncorrectCheckThreshold :MissingCheckThreshold);
+    if (!ReportCandidatesFile.empty() || !SweepMissingThresholds.empty()) {
+        string line;
+        raw_string_ostream output(line);
+        output << (isIncorrectCase ? "Potential bug, not all error values are checked for the following call: " : "Potential bug, missing check for the following call: ");
+        baseLocation.dumpToStringStream(output);
+        scoredReports.push_back({score, isIncorrectCase, output.str(), &baseLocation});
+    }
+    unsigned int logLevel = LOG_INFO;
+    if (filter) {
+        LOG(LOG_VERBOSE, "Skip: ");
+        logLevel = LOG_VERBOSE;
+    } else {
+        if (isIncorrectCase) {
+            LOG(LOG_INFO, "Potential bug, not all error values are checked for the following call: ");
         } else {
-            if (isIncorrectCase) {
-                LOG(LOG_INFO, "Potential bug, not all error values are checked for the following call: ");
-            } else {
-                LOG(LOG_INFO, "Potential bug, missing check for the following call: ");
-            }
-        }
-        baseLocation.dump(logLevel);
-        LOG(logLevel, '\n');
-        if (logLevel <= VerboseLevel) {
-            call->dump();
+            LOG(LOG_INFO, "Potential bug, missing check for the following call: ");
         }
-        LOG(logLevel, "  Score: " << format("%.2f", score * 100.0f) << "% (I=" << sum.incorrect / amount << ", C="
-                                  << (sum.total - sum.incorrect) / amount << ")\n");
+    }
+    baseLocation.dump(logLevel);
+    LOG(logLevel, '\n');
+    if (LOG_ENABLED(logLevel)) {
+        OP << *call << "\n";
+    }
+    LOG(logLevel, "  Score: " << format("%.2f", score * 100.0f) << "% (I=" << sum.incorrect / amount << ", C="
+                              << (sum.total - sum.incorrect) / amount << ")\n");
 #if 0
-        if (auto calledFunction = call->getCalledFunction(); auto subProgram = calledFunction->getSubprogram()) {
-            LOG(LOG_INFO, "  Called function defined at: " << subProgram->getFilename() << ": " << subProgram->getLine() << "\n");
-        }
+    if (auto calledFunction = call->getCalledFunction(); auto subProgram = calledFunction->getSubprogram()) {
+        LOG(LOG_INFO, "  Called function defined at: " << subProgram->getFilename() << ": " << subProgram->getLine() << "\n");
+    }
 #endif
-        if (filter) {
-            continue;
-        }
+    if (filter) {
+        return;
+    }
+    if (ReportWriter::isEnabled())
+        writeStructuredReport(call, isIncorrectCase, score, reports);
 
-        bool didOutputCallees = false;
-        for (const auto& report : reports) {
-            const auto &intervals = report.intervals;
-            LOG(LOG_INFO, "  Reported at: ");
-            auto callLocation = SourceLocation{report.call};
-            callLocation.dump();
-            LOG(LOG_INFO, "\n");
-            if (auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *call)) {
-                Interval unionOfIntervals(true);
-                Interval intersectionOfIntervals(false);
+    bool didOutputCallees = false;
+    for (const auto& report : reports) {
+        const auto &intervals = report.intervals;
+        LOG(LOG_INFO, "  Reported at: ");
+        auto callLocation = SourceLocation{report.call};
+        callLocation.dump();
+        LOG(LOG_INFO, "\n");
+        if (auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *call)) {
+            auto accumulated = Ctx->calleeIntervalCache.get(call, 0, callees.value()->second);
+            if (!didOutputCallees) {
+                LOG(LOG_INFO, "  Callees:\n");
                 for (const auto *callee: callees.value()->second) {
                     auto calleeInterval = Ctx->functionErrorReturnIntervals.maybeIntervalFor(make_pair(callee, 0));
                     if (calleeInterval.has_value() && !calleeInterval.value()->empty()) {
-                        unionOfIntervals.unionInPlace(*calleeInterval.value());
-                        intersectionOfIntervals.intersectionInPlace(*calleeInterval.value());
+                        LOG(LOG_INFO, "    -> " << callee->getName() << "\n");
+                        LOG(LOG_INFO, "       ");
+                        calleeInterval.value()->dump();
                     }
                 }
-                if (!didOutputCallees) {
-                    LOG(LOG_INFO, "  Callees:\n");
-                    for (const auto *callee: callees.value()->second) {
-                        auto calleeInterval = Ctx->functionErrorReturnIntervals.maybeIntervalFor(make_pair(callee, 0));
-                        if (calleeInterval.has_value() && !calleeInterval.value()->empty()) {
-                            LOG(LOG_INFO, "    -> " << callee->getName() << "\n");
-                            LOG(LOG_INFO, "       ");
-                            calleeInterval.value()->dump();
-                        }
-                    }
-                    didOutputCallees = true;
-                }
-                LOG(LOG_INFO, "  Union of error values: ");
-                unionOfIntervals.dump();
-                if (intervals.has_value()) {
-                    LOG(LOG_INFO, "  Checked intervals:\n    * ");
-                    intervals.value().first.dump();
-                    LOG(LOG_INFO, "    * ");
-                    intervals.value().second.dump();
-                }
-                if (intersectionOfIntervals.empty()) {
-                    LOG(LOG_INFO, "  Note: it is odd that the intersection of the error intervals for the callees is empty\n");
-                }
+                didOutputCallees = true;
+            }
+            LOG(LOG_INFO, "  Union of error values: ");
+            accumulated.unionOfNonEmpty->dump();
+            if (intervals.has_value()) {
+                LOG(LOG_INFO, "  Checked intervals:\n    * ");
+                intervals.value().first.dump();
+                LOG(LOG_INFO, "    * ");
+                intervals.value().second.dump();
+            }
+            if (accumulated.intersectionOfNonEmpty->empty()) {
+                LOG(LOG_INFO, "  Note: it is odd that the intersection of the error intervals for the callees is empty\n");
+            }
+        }
+    }
+}
+
+void ErrorCheckViolationFinderPass::writeStructuredReport(const CallInst* call, bool isIncorrectCase, float score, const vector<IncorrectCheckErrorReport>& reports) const {
+    auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *call);
+    string message = (isIncorrectCase ? "Not all error values are checked for the call in " : "Missing check for the call in ")
+                     + call->getFunction()->getName().str();
+    ReportWriter::write(isIncorrectCase ? "incorrect-check" : "missing-check", message, ReportWriter::Location::of(call, false),
+                        [&](json::OStream& json) {
+        json.attribute("caller", call->getFunction()->getName());
+        json.attribute("score", score);
+        json.attributeArray("reportedAt", [&]() {
+            for (const auto& report : reports)
+                ReportWriter::locationValue(json, ReportWriter::Location::of(report.call));
+        });
+        if (!callees)
+            return;
+        json.attributeArray("callees", [&]() {
+            for (const auto* callee : callees.value()->second) {
+                auto calleeInterval = Ctx->functionErrorReturnIntervals.maybeIntervalFor(make_pair(callee, 0));
+                if (!calleeInterval.has_value() || calleeInterval.value()->empty())
+                    continue;
+                json.object([&]() {
+                    json.attribute("function", callee->getName());
+                    ReportWriter::attributeInterval(json, "errorValues", *calleeInterval.value());
+                });
             }
+        });
+        auto accumulated = Ctx->calleeIntervalCache.get(call, 0, callees.value()->second);
+        ReportWriter::attributeInterval(json, "unionOfErrorValues", *accumulated.unionOfNonEmpty);
+        if (const auto& intervals = reports[0].intervals) {
+            json.attributeArray("checkedIntervals", [&]() {
+                ReportWriter::intervalValue(json, intervals->first);
+                ReportWriter::intervalValue(json, intervals->second);
+            });
+        }
+    });
+}
+
+void ErrorCheckViolationFinderPass::accountMemory(MemoryAccounting::MemoryReport& report) const {
+    using namespace MemoryAccounting;
+    size_t examinationBytes = approximateBytes(functionExaminations);
+    for (const auto& [function, examination] : functionExaminations) {
+        examinationBytes += HeapBytes<decltype(examination.calls)>::of(examination.calls)
+                            + HeapBytes<decltype(examination.dependencies)>::of(examination.dependencies)
+                            + HeapBytes<decltype(examination.resolvedReturnsForRoot)>::of(examination.resolvedReturnsForRoot)
+                            + HeapBytes<decltype(examination.collectedCalls)>::of(examination.collectedCalls)
+                            + HeapBytes<decltype(examination.insertedInterval)>::of(examination.insertedInterval);
+    }
+    report.add("ErrorCheckViolationFinderPass::functionExaminations", functionExaminations.size(), examinationBytes);
+    report.add("ErrorCheckViolationFinderPass::incorrectErrorReports", incorrectErrorReports);
+    report.add("ErrorCheckViolationFinderPass::unscoredReports", unscoredReports);
+    report.add("ErrorCheckViolationFinderPass::visited", visited);
+    const auto& missingCountPairs = errorFunctionToCountPairsFor(CountPairType::Missing);
+    const auto& incorrectCountPairs = errorFunctionToCountPairsFor(CountPairType::Incorrect);
+    report.add("ErrorCheckViolationFinderPass::errorFunctionToCountPairs", missingCountPairs);
+    if (&incorrectCountPairs != &missingCountPairs)
+        report.add("ErrorCheckViolationFinderPass::errorFunctionToCountPairsIncorrect", incorrectCountPairs);
+}
+
+// Writes the report candidates with their scores, and the reports that every threshold of the sweep would yield.
+// Scoring happens once, so a sweep is as fast as a single run.
+void ErrorCheckViolationFinderPass::writeScoredReports(const vector<ScoredReport>& scoredReports) const {
+    auto allReports = [&](auto callback) {
+        for (const auto& report : scoredReports)
+            callback(report);
+        for (const auto& report : unscoredReports)
+            callback(report);
+    };
+
+    if (!ReportCandidatesFile.empty()) {
+        error_code errorCode;
+        raw_fd_ostream out(ReportCandidatesFile, errorCode);
+        if (errorCode) {
+            LOG(LOG_INFO, "Cannot write " << ReportCandidatesFile << ": " << errorCode.message() << "\n");
+        } else {
+            // The score is "-" for reports that do not depend on a threshold
+            allReports([&](const ScoredReport& report) {
+                if (report.score.has_value())
+                    out << format("%.6f", report.score.value());
+                else
+                    out << "-";
+                out << "\t" << report.line << "\n";
+            });
+        }
+    }
+
+    if (!SweepMissingThresholds.empty()) {
+        if (auto errorCode = sys::fs::create_directories(SweepDirectory)) {
+            LOG(LOG_INFO, "Cannot create " << SweepDirectory << ": " << errorCode.message() << "\n");
+            return;
+        }
+        for (float threshold : SweepMissingThresholds) {
+            SmallString<128> fileName, path(SweepDirectory);
+            raw_svector_ostream(fileName) << "missing-ct-" << format("%.3f", threshold);
+            sys::path::append(path, fileName);
+            error_code errorCode;
+            raw_fd_ostream out(path, errorCode);
+            if (errorCode) {
+                LOG(LOG_INFO, "Cannot write " << path << ": " << errorCode.message() << "\n");
+                continue;
+            }
+            // Same filter as in report(), with the missing check threshold replaced
+            allReports([&](const ScoredReport& report) {
+                if (report.score.has_value() && report.score.value() < (report.isIncorrectCase ? IncorrectCheckThreshold : threshold))
+                    return;
+                out << report.line << "\n";
+            });
         }
     }
 }
@@ -581,6 +826,8 @@ void ErrorCheckViolationFinderPass::stage0(Module *M) {
 
             // Inspect error-propagation receiving functions.
             LOG(LOG_VERBOSE, "Inspecting " << functionsToInspectNext.size() << " functions\n");
+            auto iterationStart = std::chrono::steady_clock::now();
+            auto replayedBefore = examinationsReplayed;
             FunctionErrorReturnIntervals outputErrorIntervalsInNext;
             set<const Function *> functionsToInspectNextInNext;
             replaceMap.clear();
@@ -588,6 +835,13 @@ void ErrorCheckViolationFinderPass::stage0(Module *M) {
                 determineMissingChecksAndPropagationRules(*functionToInspectNext, Ctx->functionErrorReturnIntervals,
                                                           outputErrorIntervalsInNext, functionsToInspectNextInNext, handledFunctionPairs, replaceMap);
             }
+            if (LOG_ENABLED(LOG_VERBOSE)) {
+                auto replayed = examinationsReplayed - replayedBefore;
+                auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - iterationStart).count();
+                LOG(LOG_VERBOSE, "Iteration " << iterationNumber << ": worklist " << functionsToInspectNext.size()
+                                 << ", examined " << functionsToInspectNext.size() - replayed << ", replayed " << replayed
+                                 << ", " << format("%.2f", elapsed) << " ms\n");
+            }
 
             {
                 performReplaces(replaceMap);
@@ -610,7 +864,7 @@ void ErrorCheckViolationFinderPass::stage0(Module *M) {
     }
 }
 
-void ErrorCheckViolationFinderPass::determineTruncationBugs() const {
+void ErrorCheckViolationFinderPass::determineTruncationBugs() {
     for (const auto& [functionKeyPair, interval] : Ctx->functionErrorReturnIntervals) {
         if (interval.empty())
             continue;
@@ -633,8 +887,16 @@ void ErrorCheckViolationFinderPass::determineTruncationBugs() const {
                         int64_t upper = (static_cast<int64_t>(1) << (newWidth - 1)) - 1;
 
                         if (interval.lowest() < lower || interval.highest() > upper) {
-                            LOG(LOG_INFO, "Potential bug, truncation of error values: " << callerInst->getFunction()->getName() << " -> " << function->getName() << "\n");
-                            user->dump();
+                            string line = ("Potential bug, truncation of error values: " + callerInst->getFunction()->getName() + " -> " + function->getName()).str();
+                            LOG(LOG_INFO, line << "\n");
+                            ReportWriter::write("truncation", line, ReportWriter::Location::of(trunc), [&](json::OStream& json) {
+                                json.attribute("caller", callerInst->getFunction()->getName());
+                                json.attribute("callee", function->getName());
+                                json.attribute("width", static_cast<int64_t>(newWidth));
+                                ReportWriter::attributeInterval(json, "errorValues", interval);
+                            });
+                            unscoredReports.push_back({nullopt, false, std::move(line), nullptr});
+                            LOG(LOG_INFO, *user << "\n");
                         }
                     }
                 }
@@ -643,7 +905,7 @@ void ErrorCheckViolationFinderPass::determineTruncationBugs() const {
     }
 }
 
-void ErrorCheckViolationFinderPass::determineSignednessBugs() const {
+void ErrorCheckViolationFinderPass::determineSignednessBugs() {
     struct SignednessCounter {
         unsigned int neg1 = 0, zero = 0, pos1 = 0;
 
@@ -678,7 +940,7 @@ void ErrorCheckViolationFinderPass::determineSignednessBugs() const {
             typeToSignednessCounter[returnTypeCallee->getName()].update(signedness);
         }
     }
-    if (VerboseLevel >= LOG_VERBOSE) {
+    if (LOG_ENABLED(LOG_VERBOSE)) {
         for (const auto &[name, counter]: typeToSignednessCounter) {
             LOG(LOG_VERBOSE, "Signedness " << name << ": " << counter.verdict() << "\t" << counter.neg1 << ", " << counter.zero << "," << counter.pos1 << "\n");
         }
@@ -700,17 +962,90 @@ void ErrorCheckViolationFinderPass::determineSignednessBugs() const {
                 continue;
             auto verdict = typeToSignednessCounter[returnTypeCallee->getName()].verdict();
             if (verdict != 0 && signedness != verdict) {
-                LOG(LOG_INFO, "Potential bug, signedness bug: " << functionKeyPair.first->getName() << "\n");
+                string line = ("Potential bug, signedness bug: " + functionKeyPair.first->getName()).str();
+                LOG(LOG_INFO, line << "\n");
+                ReportWriter::write("signedness", line, ReportWriter::Location::of(functionKeyPair.first), [&](json::OStream& json) {
+                    json.attribute("function", functionKeyPair.first->getName());
+                    json.attribute("returnType", returnTypeCallee->getName());
+                    ReportWriter::attributeInterval(json, "errorValues", interval);
+                });
+                unscoredReports.push_back({nullopt, false, std::move(line), nullptr});
             }
         }
     }
 }
 
 void ErrorCheckViolationFinderPass::stage1(Module* M) {
+    // The reports start on their own line, after the progress output of the pass
+    if (ProgressiveReport && M == Ctx->Modules.front())
+        OP << "\n";
     for (const auto& function : *M) {
         if (Ctx->shouldSkipFunction(&function))
             continue;
 
         determineIncorrectChecks(function);
+        if (ProgressiveReport)
+            emitFinalizedReports(function);
+    }
+}
+
+void ErrorCheckViolationFinderPass::prepareProgressiveReport() {
+    // Stage 1 examines every function that is not skipped once, the counts of a callee are final after its last caller
+    DenseSet<pair<const Function*, const Function*>> callerCalleePairs;
+    for (const auto& [call, callees] : Ctx->Callees) {
+        auto caller = call->getFunction();
+        if (Ctx->shouldSkipFunction(caller))
+            continue;
+        for (const auto* callee : callees) {
+            if (callerCalleePairs.insert({caller, callee}).second) {
+                pendingCallerCount[callee]++;
+                calleesOfCaller[caller].push_back(callee);
+            }
+        }
+    }
+
+    // The missing check reports of stage 0
+    for (const auto* locationAndReports : reportLocationsInSourceOrder())
+        waitForNextPendingCallee(*locationAndReports);
+    Log::flush();
+    ReportWriter::flush();
+}
+
+void ErrorCheckViolationFinderPass::waitForNextPendingCallee(const ReportMap::value_type& locationAndReports) {
+    const auto& [baseLocation, reports] = locationAndReports;
+    if (auto callees = getCalleeIteratorForPotentialCallInstruction(GlobalCtx, *reports[0].call)) {
+        for (const auto* callee : callees.value()->second) {
+            auto it = pendingCallerCount.find(callee);
+            if (it != pendingCallerCount.end() && it->second > 0) {
+                locationsWaitingFor[callee].push_back(&locationAndReports);
+                return;
+            }
+        }
+    }
+    reportLocation(baseLocation, reports, progressiveScoredReports);
+    progressivelyReported.insert(&baseLocation);
+}
+
+void ErrorCheckViolationFinderPass::emitFinalizedReports(const Function& function) {
+    for (const auto* locationAndReports : newReportLocations)
+        waitForNextPendingCallee(*locationAndReports);
+    newReportLocations.clear();
+
+    auto it = calleesOfCaller.find(&function);
+    if (it == calleesOfCaller.end())
+        return;
+    for (const auto* callee : it->second) {
+        if (--pendingCallerCount[callee] > 0)
+            continue;
+        auto waitingIt = locationsWaitingFor.find(callee);
+        if (waitingIt == locationsWaitingFor.end())
+            continue;
+        auto waiting = std::move(waitingIt->second);
+        locationsWaitingFor.erase(waitingIt);
+        for (const auto* locationAndReports : waiting)
+            waitForNextPendingCallee(*locationAndReports);
     }
+    // Make the reports visible right away
+    Log::flush();
+    ReportWriter::flush();
 }
@@ -2,6 +2,7 @@
 
 #include "Analyzer.h"
 #include "Common.h"
+#include "MemoryAccounting.h"
 
 class ErrorCheckViolationFinderPass : public IterativeModulePass {
 public:
@@ -12,18 +13,57 @@ public:
     bool doFinalization(llvm::Module *) override;
     void doModulePass(llvm::Module *) override;
     void finish();
-    inline void nextStage() { stage++; }
+    void nextStage();
     void stage0(Module*);
     void stage1(Module*);
 
     void determineMissingChecksAndPropagationRules(const Function& function, const FunctionErrorReturnIntervals& inputErrorIntervals, FunctionErrorReturnIntervals& outputErrorIntervals, set<const Function*>& functionsToInspectNext, unordered_set<uintptr_t>& handledFunctionPairs, map<pair<const Function*, unsigned int>, Interval>& replaceMap);
     void determineIncorrectChecks(const Function& function);
-    void determineTruncationBugs() const;
-    void determineSignednessBugs() const;
+    void determineTruncationBugs();
+    void determineSignednessBugs();
     void performReplaces(map<pair<const Function*, unsigned int>, Interval>& replaceMap);
     void report() const;
+    void accountMemory(MemoryAccounting::MemoryReport& report) const;
 
 private:
+    // Return value of a path from a root to a return, resolved without leaving the path.
+    // This does not depend on the error intervals, so it is computed only once per root.
+    struct ResolvedReturn {
+        const ReturnInst* ret;
+        const Value* resolvedValue;
+        // Only if resolvedValue is a comparison: the resolved compared value and the constant it is compared to
+        const Value* comparedValue;
+        optional<int> rhs;
+    };
+
+    // Cached data and outcome of determineMissingChecksAndPropagationRules for a function.
+    struct FunctionExamination {
+        // Calls with callees, and the deduplicated callees: the only intervals the examination depends on
+        bool callsCollected = false;
+        vector<pair<const CallInst*, const FlatFuncSet*>> calls;
+        vector<const Function*> dependencies;
+        DenseMap<const BasicBlock*, vector<ResolvedReturn>> resolvedReturnsForRoot;
+        optional<set<const Value*>> collectedCalls;
+
+        // Outcome of the last examination
+        bool examined = false;
+        uint64_t examinedAtEpoch = 0;
+        unsigned int examinedAtConfidenceEpoch = 0;
+        bool replaced = false;
+        bool notifiedCallers = false;
+        optional<Interval> insertedInterval;
+    };
+
+    FunctionExamination& examinationFor(const Function& function);
+    const vector<ResolvedReturn>& resolvedReturnsFor(FunctionExamination& examination, const BasicBlock* root);
+    [[nodiscard]] bool isExaminationUpToDate(const Function& function, const FunctionExamination& examination, const FunctionErrorReturnIntervals& inputErrorIntervals) const;
+    void notifyCallersOfPropagation(const Function& function, set<const Function*>& functionsToInspectNext, unordered_set<uintptr_t>& handledFunctionPairs);
+
+    DenseMap<const Function*, FunctionExamination> functionExaminations;
+    // Bumped whenever this pass changes a confidence, examinations depend on those too
+    unsigned int confidenceEpoch = 0;
+    unsigned int examinationsReplayed = 0;
+
     struct IncorrectCheckErrorReport {
         optional<pair<Interval, Interval>> intervals;
         const CallInst* call;
@@ -40,9 +80,43 @@ private:
         }
     };
 
-    unordered_map<SourceLocation, vector<IncorrectCheckErrorReport>, SourceLocationHasher> incorrectErrorReports;
+    // A report line, and its score if it is subject to a threshold.
+    struct ScoredReport {
+        optional<float> score;
+        bool isIncorrectCase;
+        string line;
+        // Of the reports of a call, such that they are written in source order
+        const SourceLocation* location;
+    };
+
+    void reportLocation(const SourceLocation& baseLocation, const vector<IncorrectCheckErrorReport>& reports, vector<ScoredReport>& scoredReports) const;
+    void writeScoredReports(const vector<ScoredReport>& scoredReports) const;
+    void writeStructuredReport(const CallInst* call, bool isIncorrectCase, float score, const vector<IncorrectCheckErrorReport>& reports) const;
+
+    using ReportMap = unordered_map<SourceLocation, vector<IncorrectCheckErrorReport>, SourceLocationHasher>;
+    ReportMap incorrectErrorReports;
+    // The map is ordered by the file ids, which depend on the thread timing, the source order is the same in every run
+    [[nodiscard]] vector<const ReportMap::value_type*> reportLocationsInSourceOrder() const;
+    // Truncation and signedness reports, which do not depend on a threshold
+    vector<ScoredReport> unscoredReports;
     DenseSet<const void*> visited;
 
+    // With --progressive-report, the reports of a location are emitted during stage 1, as soon as the counts of all
+    // callees of its call are final: the error intervals are final after stage 0 already, and the counts of a callee
+    // once stage 1 examined all of its callers. The remaining locations are reported by finish().
+    void prepareProgressiveReport();
+    void waitForNextPendingCallee(const ReportMap::value_type& locationAndReports);
+    void emitFinalizedReports(const Function& function);
+
+    DenseMap<const Function*, unsigned int> pendingCallerCount;
+    DenseMap<const Function*, vector<const Function*>> calleesOfCaller;
+    // Locations by the callee whose counts they wait for
+    DenseMap<const Function*, vector<const ReportMap::value_type*>> locationsWaitingFor;
+    // Locations that got their first report in the function that is being examined
+    vector<const ReportMap::value_type*> newReportLocations;
+    DenseSet<const SourceLocation*> progressivelyReported;
+    vector<ScoredReport> progressiveScoredReports;
+
     enum class CountPairType {
         Missing, Incorrect,
     };
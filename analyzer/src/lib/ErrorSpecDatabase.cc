@@ -0,0 +1,129 @@
+#include <cmath>
+#include <cstring>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include "ErrorSpecDatabase.h"
+#include "BinaryReader.h"
+#include "Analyzer.h"
+
+namespace {
+
+constexpr char Magic[8] = {'E', 'S', 'S', 'S', 'S', 'P', 'E', 'C'};
+constexpr uint32_t Version = 1;
+
+}
+
+bool ErrorSpecDatabase::exportTo(StringRef path, const GlobalContext& ctx, string& error) {
+    string buffer;
+    raw_string_ostream stream(buffer);
+    support::endian::Writer writer(stream, support::little);
+
+    uint32_t count = 0;
+    for (const auto& [key, interval] : ctx.functionErrorReturnIntervals) {
+        const auto* function = key.first;
+        if (!function->hasName() || function->hasLocalLinkage())
+            continue;
+        auto confidenceIt = ctx.functionToConfidence.find(key);
+        float confidence = confidenceIt == ctx.functionToConfidence.end() ? NAN : confidenceIt->second;
+
+        writer.write<uint32_t>(function->getName().size());
+        stream << function->getName();
+        writer.write<uint32_t>(key.second);
+        writer.write<float>(confidence);
+        writer.write<uint32_t>(interval.getRanges().size());
+        for (const auto& range : interval.getRanges()) {
+            writer.write<int32_t>(range.low);
+            writer.write<int32_t>(range.high);
+        }
+        ++count;
+    }
+
+    error_code errorCode;
+    raw_fd_ostream out(path, errorCode);
+    if (errorCode) {
+        error = errorCode.message();
+        return false;
+    }
+    out.write(Magic, sizeof(Magic));
+    support::endian::Writer headerWriter(out, support::little);
+    headerWriter.write<uint32_t>(Version);
+    headerWriter.write<uint32_t>(count);
+    out << stream.str();
+    return true;
+}
+
+bool ErrorSpecDatabase::read(StringRef path, vector<ErrorSpec>& specs, string& error) {
+    auto bufferOrError = MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+    if (!bufferOrError) {
+        error = bufferOrError.getError().message();
+        return false;
+    }
+
+    BinaryReader reader((*bufferOrError)->getBuffer());
+    StringRef magic;
+    uint32_t version, count;
+    if (!reader.readBytes(sizeof(Magic), magic) || memcmp(magic.data(), Magic, sizeof(Magic)) != 0) {
+        error = "not an error specification database";
+        return false;
+    }
+    if (!reader.read(version) || version != Version) {
+        error = "unsupported database version";
+        return false;
+    }
+    if (!reader.read(count)) {
+        error = "truncated header";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t returnIndex, rangeCount;
+        float confidence;
+        StringRef name;
+        if (!reader.readString(name) || !reader.read(returnIndex) || !reader.read(confidence) || !reader.read(rangeCount)) {
+            error = "truncated entry";
+            return false;
+        }
+
+        Interval interval(true);
+        for (uint32_t j = 0; j < rangeCount; ++j) {
+            int32_t low, high;
+            if (!reader.read(low) || !reader.read(high)) {
+                error = "truncated entry";
+                return false;
+            }
+            // Keep the interval invariant: sorted and disjoint
+            auto ranges = interval.getRanges();
+            if (low > high || (!ranges.empty() && ranges.back().high >= low)) {
+                error = "malformed interval for " + name.str();
+                return false;
+            }
+            interval.appendUnsafeBecauseExpectsSortMaintained(Range(low, high));
+        }
+
+        specs.push_back(ErrorSpec {name.str(), returnIndex, std::move(interval),
+                                   std::isnan(confidence) ? nullopt : make_optional(confidence)});
+    }
+    if (!reader.atEnd()) {
+        error = "trailing data";
+        return false;
+    }
+    return true;
+}
+
+size_t ErrorSpecDatabase::seed(const vector<ErrorSpec>& specs, GlobalContext& ctx) {
+    size_t seeded = 0;
+    for (const auto& spec : specs) {
+        // Only declarations: functions with a body in the inputs are analyzed as usual
+        auto functionIt = ctx.GlobalFuncs.find(spec.name);
+        if (functionIt == ctx.GlobalFuncs.end() || !functionIt->second || !functionIt->second->empty())
+            continue;
+        auto key = make_pair(static_cast<const Function*>(functionIt->second), spec.returnIndex);
+        ctx.functionErrorReturnIntervals.replaceIntervalFor(key, Interval(spec.interval));
+        if (spec.confidence.has_value())
+            ctx.functionToConfidence[key] = *spec.confidence;
+        ++seeded;
+    }
+    return seeded;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+#include "Interval.h"
+
+struct GlobalContext;
+
+/**
+ * On-disk database of learned error specifications, keyed by symbol name such that specifications of a stable
+ * dependency (e.g. libc) can be learned once and imported into analyses that do not load the dependency itself.
+ *
+ * Format (little endian): magic "ESSSSPEC", u32 version, u32 entry count, followed by the entries:
+ *   u32 name length, name, u32 return value index, f32 confidence (NaN if unknown), u32 range count, (i32 low, i32 high)*
+ */
+namespace ErrorSpecDatabase {
+
+// Writes the error intervals and confidences of all functions with a non-local symbol name.
+bool exportTo(llvm::StringRef path, const GlobalContext& ctx, std::string& error);
+
+struct ErrorSpec {
+    std::string name;
+    unsigned int returnIndex;
+    Interval interval;
+    std::optional<float> confidence;
+};
+
+// Appends the entries of the database to specs. Returns false and sets the error message on failure.
+bool read(llvm::StringRef path, std::vector<ErrorSpec>& specs, std::string& error);
+
+// Seeds the intervals of functions that are only declared in the inputs, returns the number of seeded intervals.
+size_t seed(const std::vector<ErrorSpec>& specs, GlobalContext& ctx);
+
+}
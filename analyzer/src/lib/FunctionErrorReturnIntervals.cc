@@ -1,42 +1,67 @@
 #include <llvm/Demangle/Demangle.h>
 #include "FunctionErrorReturnIntervals.h"
+#include "MemoryAccounting.h"
+#include "ReportWriter.h"
 
 
 void FunctionErrorReturnIntervals::mergeDestructivelyForOther(FunctionErrorReturnIntervals& other) {
-    for (auto& [function, interval] : other.intervals) {
-        if (auto it = intervals.find(function); it != intervals.end()) {
-            it->second.unionInPlace(interval);
+    for (auto& [function, interval] : other.entries) {
+        if (auto it = index.find(function); it != index.end()) {
+            // Merging what we already have is not a modification, keep the version such that dependents stay valid
+            auto& existing = entries[it->second].second;
+            if (interval.isSubsetOf(existing))
+                continue;
+            existing.unionInPlace(interval);
+            versions[it->second] = ++currentEpoch;
         } else {
-            intervals.emplace(function, std::move(interval));
+            append(function, std::move(interval));
         }
     }
 }
 
+size_t FunctionErrorReturnIntervals::approximateHeapBytes() const {
+    using namespace MemoryAccounting;
+    return HeapBytes<Storage>::of(entries) + HeapBytes<std::vector<uint64_t>>::of(versions) + HeapBytes<DenseMap<Key, unsigned int>>::of(index);
+}
+
 void FunctionErrorReturnIntervals::dump() const {
-    std::vector<std::pair<decltype(intervals)::key_type, std::reference_wrapper<const decltype(intervals)::mapped_type>>> sorted;
-    sorted.reserve(intervals.size());
+    std::vector<const Entry*> sorted;
+    sorted.reserve(entries.size());
 
-    auto intervalCount = intervals.size();
-    for (const auto& [pair, interval] : intervals) {
-        auto function = pair.first;
+    auto intervalCount = entries.size();
+    for (const auto& entry : entries) {
+        auto function = entry.first.first;
         if (function->getParent()->getName().contains("/libc.so.bc"))
             --intervalCount;
-        sorted.emplace_back(pair, std::cref(interval));
+        sorted.push_back(&entry);
     }
 
-    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
-        return a.first.first->getName().str() < b.first.first->getName().str();
+    // StringRef comparison, no temporary strings. Ties are broken by return index and insertion order.
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+        int order = a->first.first->getName().compare(b->first.first->getName());
+        if (order != 0)
+            return order < 0;
+        return a->first.second < b->first.second;
     });
 
-    LOG(LOG_INFO, "Function error return intervals (" << intervalCount << ", pre-libc-pruning " << intervals.size() << "):\n");
-    for (const auto& [pair, intervalRef] : sorted) {
-        auto function = pair.first;
-        const auto& interval = intervalRef.get();
+    LOG(LOG_INFO, "Function error return intervals (" << intervalCount << ", pre-libc-pruning " << entries.size() << "):\n");
+    for (const auto* entry : sorted) {
+        auto function = entry->first.first;
+        const auto& interval = entry->second;
 #if 1
         if (function->getParent()->getName().contains("/libc.so.bc"))
             continue;
 #endif
-        LOG(LOG_INFO, "Function: " << (function ? demangle(function->getName().str()) : "?") << " {return index " << pair.second << "}\n  ");
+        LOG(LOG_INFO, "Function: " << (function ? demangle(function->getName().str()) : "?") << " {return index " << entry->first.second << "}\n  ");
         interval.dump();
+        if (ReportWriter::isEnabled()) {
+            auto name = demangle(function->getName().str());
+            ReportWriter::write("error-specification", "Error values of " + name + ": " + interval.toString(),
+                                ReportWriter::Location::of(function), [&](json::OStream& json) {
+                json.attribute("function", name);
+                json.attribute("returnIndex", static_cast<int64_t>(entry->first.second));
+                ReportWriter::attributeInterval(json, "intervals", interval);
+            });
+        }
     }
 }
@@ -2,8 +2,12 @@
 
 #include "Interval.h"
 #include "Common.h"
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <optional>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
 
 
 enum IntervalSource {
@@ -11,65 +15,146 @@ enum IntervalSource {
 };
 
 
+/**
+ * Flat store of the error return intervals of (function, return value index) pairs.
+ * Entries live in a dense array in insertion order, a hash index maps keys to their dense id.
+ * References to intervals stay valid on insertion. Iteration is in insertion order, such that it is deterministic and
+ * independent of pointer values, and it visits the entries that are inserted while iterating, like iterating the
+ * ordered map this replaces visited entries inserted after the current one.
+ * The entries are not synchronized: they are only modified while no other thread reads them. Only the epoch counter
+ * is atomic.
+ *
+ * Every mutation stamps the entry with a new value of a global epoch counter once the new interval is written, such
+ * that derived data (see CalleeIntervalCache) can be validated cheaply: data derived at an epoch saw every interval
+ * with a version up to that epoch.
+ */
 class FunctionErrorReturnIntervals {
+public:
+    using Key = pair<const Function*, unsigned int>;
+    using Entry = pair<const Key, Interval>;
+
 private:
-    using Map = map<pair<const Function*, unsigned int>, Interval>;
+    using Storage = std::deque<Entry>;
+
+    // Index-based iterator, stays valid while entries get appended.
+    template<typename StorageType, typename EntryType>
+    class Iterator {
+    public:
+        Iterator(StorageType* storage, size_t index) : storage(storage), index(index) {}
+
+        inline EntryType& operator*() const { return (*storage)[index]; }
+        inline EntryType* operator->() const { return &(*storage)[index]; }
+        inline Iterator& operator++() { ++index; return *this; }
+
+        // The end iterator is a sentinel that follows the size of the storage.
+        inline bool operator==(const Iterator& other) const {
+            return (atEnd() && other.atEnd()) || (storage == other.storage && index == other.index);
+        }
+        inline bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        [[nodiscard]] inline bool atEnd() const { return index >= storage->size(); }
+
+        StorageType* storage;
+        size_t index;
+    };
 
 public:
-    inline void insertIntervalFor(pair<const Function*, unsigned int> function, Interval&& interval) {
-        intervals.emplace(function, std::move(interval));
+    using const_iterator = Iterator<const Storage, const Entry>;
+
+    FunctionErrorReturnIntervals() = default;
+    FunctionErrorReturnIntervals(FunctionErrorReturnIntervals&& other) noexcept
+        : entries(std::move(other.entries)), versions(std::move(other.versions)), index(std::move(other.index)),
+          currentEpoch(other.currentEpoch.load()) {}
+    FunctionErrorReturnIntervals& operator=(FunctionErrorReturnIntervals&& other) noexcept {
+        entries = std::move(other.entries);
+        versions = std::move(other.versions);
+        index = std::move(other.index);
+        // Keep epochs monotonic, derived data might still refer to the old ones. The moved-in stamps come from another
+        // epoch counter, so every entry counts as modified now.
+        currentEpoch = std::max(currentEpoch.load(), other.currentEpoch.load()) + 1;
+        std::fill(versions.begin(), versions.end(), currentEpoch.load());
+        return *this;
+    }
+
+    inline void insertIntervalFor(Key function, Interval&& interval) {
+        if (!index.count(function))
+            append(function, std::move(interval));
     }
 
-    inline void replaceIntervalFor(pair<const Function*, unsigned int> function, Interval&& interval) {
-        intervals[function] = std::move(interval);
+    inline void replaceIntervalFor(Key function, Interval&& interval) {
+        if (auto it = index.find(function); it != index.end()) {
+            entries[it->second].second = std::move(interval);
+            versions[it->second] = ++currentEpoch;
+        } else {
+            append(function, std::move(interval));
+        }
     }
 
-    inline Interval& intervalFor(pair<const Function*, unsigned int> function, bool emptyByDefault=false) {
-        auto intervalIt = intervals.find(function);
-        if (intervalIt == intervals.end())
-            return intervals.insert({function, Interval{emptyByDefault}}).first->second;
-        return intervalIt->second;
+    // Modifies the interval in place, creating it first if there is none. Conservatively counts as a modification.
+    inline void updateIntervalFor(Key function, function_ref<void(Interval&)> update, bool emptyByDefault=false) {
+        if (auto it = index.find(function); it != index.end()) {
+            update(entries[it->second].second);
+            versions[it->second] = ++currentEpoch;
+        } else {
+            Interval interval{emptyByDefault};
+            update(interval);
+            append(function, std::move(interval));
+        }
     }
 
-    [[nodiscard]] inline optional<const Interval*> maybeIntervalFor(pair<const Function*, unsigned int> function) const {
-        auto intervalIt = intervals.find(function);
-        if (intervalIt == intervals.end())
+    [[nodiscard]] inline optional<const Interval*> maybeIntervalFor(Key function) const {
+        auto it = index.find(function);
+        if (it == index.end())
             return {};
-        return &intervalIt->second;
+        return &entries[it->second].second;
+    }
+
+    // Epoch of the last modification of the entry, 0 if there is no entry.
+    [[nodiscard]] inline uint64_t versionOf(Key function) const {
+        auto it = index.find(function);
+        if (it == index.end())
+            return 0;
+        return versions[it->second];
+    }
+
+    // Epoch of the last modification of any entry.
+    [[nodiscard]] inline uint64_t epoch() const {
+        return currentEpoch;
     }
 
     [[nodiscard]] inline bool empty() const {
-        return intervals.empty();
+        return entries.empty();
     }
 
     [[nodiscard]] inline size_t size() const {
-        return intervals.size();
+        return entries.size();
     }
 
     void mergeDestructivelyForOther(FunctionErrorReturnIntervals& other);
 
     void dump() const;
 
-    [[nodiscard]] Map::const_iterator begin() const {
-        return intervals.begin();
-    }
+    // Approximate heap memory owned by the store, see MemoryAccounting
+    [[nodiscard]] size_t approximateHeapBytes() const;
 
-    [[nodiscard]] Map::const_iterator end() const {
-        return intervals.end();
+    [[nodiscard]] const_iterator begin() const {
+        return {&entries, 0};
     }
 
-    [[nodiscard]] Map::iterator begin() {
-        return intervals.begin();
+    [[nodiscard]] const_iterator end() const {
+        return {&entries, SIZE_MAX};
     }
 
-    [[nodiscard]] Map::iterator end() {
-        return intervals.end();
-    }
-
-    Map::iterator erase(Map::iterator it) {
-        return intervals.erase(it);
+private:
+    inline void append(Key function, Interval&& interval) {
+        index.try_emplace(function, static_cast<unsigned int>(entries.size()));
+        entries.emplace_back(function, std::move(interval));
+        versions.push_back(++currentEpoch);
     }
 
-private:
-    Map intervals;
+    Storage entries;
+    std::vector<uint64_t> versions;
+    DenseMap<Key, unsigned int> index;
+    std::atomic<uint64_t> currentEpoch = 0;
 };
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/Support/Format.h>
+#include "FunctionProfiler.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace FunctionProfiler {
+
+struct Profile {
+    chrono::nanoseconds time[static_cast<size_t>(Activity::Count)] = {};
+    uint64_t work[static_cast<size_t>(Work::Count)] = {};
+
+    [[nodiscard]] chrono::nanoseconds total() const {
+        chrono::nanoseconds sum {0};
+        for (auto t : time)
+            sum += t;
+        return sum;
+    }
+};
+
+static bool Enabled = false;
+static mutex ProfilesLock;
+static DenseMap<const Function*, Profile> Profiles;
+static thread_local Scope* Current = nullptr;
+
+void enable() {
+    Enabled = true;
+}
+
+bool isEnabled() {
+    return Enabled;
+}
+
+static const char* const ActivityNames[] = {"path analysis", "missing checks", "vsa"};
+
+Scope::Scope(const Function& function, Activity activity) : activity(activity) {
+    if (Trace::isFunctionTracingEnabled())
+        span.emplace(function.getName(), ActivityNames[static_cast<size_t>(activity)]);
+    if (!Enabled)
+        return;
+    this->function = &function;
+    parent = Current;
+    Current = this;
+    start = chrono::steady_clock::now();
+}
+
+Scope::~Scope() {
+    if (!function)
+        return;
+    auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    Current = parent;
+    if (parent)
+        parent->nested += elapsed;
+
+    lock_guard _(ProfilesLock);
+    auto& profile = Profiles[function];
+    profile.time[static_cast<size_t>(activity)] += elapsed - nested;
+    for (size_t i = 0; i < static_cast<size_t>(Work::Count); ++i)
+        profile.work[i] += work[i];
+}
+
+void count(Work work, uint64_t amount) {
+    if (auto* scope = Current)
+        scope->work[static_cast<size_t>(work)] += amount;
+}
+
+static double toMilliseconds(chrono::nanoseconds duration) {
+    return chrono::duration<double, milli>(duration).count();
+}
+
+void print(raw_ostream& out, unsigned int top) {
+    lock_guard _(ProfilesLock);
+    vector<pair<const Function*, const Profile*>> sorted;
+    sorted.reserve(Profiles.size());
+    for (const auto& [function, profile] : Profiles)
+        sorted.emplace_back(function, &profile);
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        auto aTotal = a.second->total(), bTotal = b.second->total();
+        if (aTotal != bTotal)
+            return aTotal > bTotal;
+        return a.first->getName() < b.first->getName();
+    });
+    if (sorted.size() > top)
+        sorted.resize(top);
+
+    out << "===== Top " << sorted.size() << " functions by analysis time (of " << Profiles.size() << " profiled) =====\n";
+    out << "  Total (ms)  Paths (ms)  Checks (ms)  VSA (ms)      paths  summaries  comparisons  resolutions  Function\n";
+    for (const auto& [function, profile] : sorted) {
+        out << format("%12.3f%12.3f%13.3f%10.3f", toMilliseconds(profile->total()),
+                      toMilliseconds(profile->time[static_cast<size_t>(Activity::PathAnalysis)]),
+                      toMilliseconds(profile->time[static_cast<size_t>(Activity::MissingChecks)]),
+                      toMilliseconds(profile->time[static_cast<size_t>(Activity::VSA)]))
+            << format("%11llu%11llu%13llu%13llu",
+                      static_cast<unsigned long long>(profile->work[static_cast<size_t>(Work::Paths)]),
+                      static_cast<unsigned long long>(profile->work[static_cast<size_t>(Work::Summaries)]),
+                      static_cast<unsigned long long>(profile->work[static_cast<size_t>(Work::Comparisons)]),
+                      static_cast<unsigned long long>(profile->work[static_cast<size_t>(Work::Resolutions)]))
+            << "  " << function->getName();
+        if (auto* subProgram = function->getSubprogram())
+            out << " (" << subProgram->getFilename() << ": " << subProgram->getLine() << ")";
+        out << "\n";
+    }
+}
+
+}
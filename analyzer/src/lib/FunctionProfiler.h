@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <llvm/IR/Function.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Trace.h"
+
+/**
+ * Opt-in profile of the time and work spent on individual functions, to find the functions that make a run slow.
+ * A scope attributes the time between its construction and destruction to a function and an activity, excluding
+ * nested scopes. Work counted on a thread is attributed to the innermost scope of that thread.
+ * When the profiler is disabled, scopes and counts only test a flag.
+ * With --trace-functions, scopes are also recorded as trace spans, independent of the profiler.
+ */
+namespace FunctionProfiler {
+
+enum class Activity {
+    // Path collection and summary comparison of EHBlockDetectorPass stage 0
+    PathAnalysis,
+    // determineMissingChecksAndPropagationRules
+    MissingChecks,
+    // Return value set analysis
+    VSA,
+    Count
+};
+
+enum class Work {
+    Paths,
+    Summaries,
+    Comparisons,
+    Resolutions,
+    Count
+};
+
+void enable();
+[[nodiscard]] bool isEnabled();
+
+class Scope {
+public:
+    Scope(const llvm::Function& function, Activity activity);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const llvm::Function* function = nullptr;
+    Activity activity;
+    Scope* parent = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds nested {0};
+    uint64_t work[static_cast<size_t>(Work::Count)] = {};
+    std::optional<Trace::Span> span;
+
+    friend void count(Work work, uint64_t amount);
+};
+
+void count(Work work, uint64_t amount = 1);
+
+// Prints the top most expensive functions with their source location.
+void print(llvm::raw_ostream& out, unsigned int top);
+
+}
@@ -7,6 +7,8 @@
 #include "ClOptForward.h"
 #include "DataFlowAnalysis.h"
 #include "Helpers.h"
+#include "Statistics.h"
+#include "FunctionProfiler.h"
 #include <llvm/IR/Dominators.h>
 #include <llvm/IR/InstIterator.h>
 
@@ -16,7 +18,7 @@
 static const Interval* getUniqueInterval(const FunctionToIntervalCounts& allIntervals, pair<const Function*, unsigned int> index) {
     if (auto it = allIntervals.find(index); it != allIntervals.end()) {
         if (it->second.size() == 1) {
-            return &it->second.begin()->first;
+            return &*it->second.begin()->first;
         }
     }
     return nullptr;
@@ -42,13 +44,13 @@ IntervalHashMap FunctionVSA::refine(const Function* function, IntervalHashMap& m
     auto functionErrorReturnIntervalsIt = map.begin();
     auto functionErrorReturnIntervalsItEnd = map.end();
     IntervalHashMap result;
+    auto& pool = IntervalPool::get();
     ValueSet valueSet;
+    Statistics::VSACalls.increment();
+    FunctionProfiler::Scope profile(*function, FunctionProfiler::Activity::VSA);
     auto constantRange = computeConstantRangeFor(function, valueSet);
-    if (VerboseLevel >= LOG_VERBOSE) {
-        LOG(LOG_VERBOSE, "VSA for: " << function->getName() << " ");
-        constantRange.dump();
-        LOG(LOG_VERBOSE, "\n");
-    }
+    FunctionProfiler::count(FunctionProfiler::Work::Resolutions, valueSet.size());
+    LOG(LOG_VERBOSE, "VSA for: " << function->getName() << " " << constantRange << "\n");
     for (; functionErrorReturnIntervalsIt != functionErrorReturnIntervalsItEnd; ++functionErrorReturnIntervalsIt) {
         auto interval = functionErrorReturnIntervalsIt->first;
         if (!constantRange.isEmptySet() && !constantRange.isFullSet()) {
@@ -64,17 +66,17 @@ IntervalHashMap FunctionVSA::refine(const Function* function, IntervalHashMap& m
 #if 0
             LOG(LOG_INFO, "Narrowing " << function->getName() << " from -> to:\n");
             constantRange.dump();
-            interval.dump();
+            interval->dump();
 #endif
-            interval.intersectionInPlace(tmp);
+            interval = pool.intersection(interval, pool.intern(std::move(tmp)));
         } else if (constantRange.isEmptySet()) {
-            interval.clear();
+            interval = pool.empty();
         }
 
         if (auto it = result.find(interval); it != result.end()) {
             it->second += functionErrorReturnIntervalsIt->second;
         } else {
-            result.emplace(std::move(interval), functionErrorReturnIntervalsIt->second);
+            result.emplace(interval, functionErrorReturnIntervalsIt->second);
         }
     }
     return result;
@@ -109,12 +111,8 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Value* V, const Instruc
         if (calleesIt != GlobalCtx.Callees.end() && !calleesIt->second.empty()) {
             for (const auto *callee: calleesIt->second) {
                 range = range.unionWith(computeConstantRangeFor(callee, valueSet));
-                if (VerboseLevel >= LOG_VERBOSE) {
-                    LOG(LOG_INFO,
-                        "  Callee: " << C->getFunction()->getName() << " -> " << callee->getName() << "\n");
-                    range.dump();
-                    LOG(LOG_INFO, "\n");
-                }
+                LOG(LOG_VERBOSE, "  Callee: " << C->getFunction()->getName() << " -> " << callee->getName() << "\n"
+                                 << range << "\n");
                 if (range.isFullSet()) // Fast failure path
                     return range;
             }
@@ -136,20 +134,10 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Value* V, const Instruc
             if (valueRange.getLower().getSExtValue() > valueRange.getUpper().getSExtValue()) {
                 valueRange = ConstantRange{valueRange.getUpper(), valueRange.getLower()};
             }
-            if (C->getFunction()->getName().equals("BIO_ctrl")) {
-                LOG(LOG_INFO, "ABCD\n");
-                phi->getIncomingValue(i)->dump();
-                valueRange.dump();
-                LOG(LOG_INFO, "\n");
-                range.dump();
-                LOG(LOG_INFO, "\n");
-                LOG(LOG_INFO, "\n");
-            }
             range = range.unionWith(valueRange);
             if (range.isFullSet()) { // Fast failure path
-                LOG(LOG_INFO, "phi range full set: " << C->getFunction()->getName() << "\n");
-                phi->getIncomingValue(i)->dump();
-                phi->dump();
+                LOG(LOG_DEBUG, "phi range full set: " << C->getFunction()->getName() << "\n"
+                               << *phi->getIncomingValue(i) << "\n" << *phi << "\n");
                 return range;
             }
         }
@@ -192,6 +180,7 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Value* V, const Instruc
         bool has = false;
         for (const auto& instruction : instructions(C->getFunction())) {
             if (auto store = dyn_cast<StoreInst>(&instruction)) {
+                Statistics::AliasQueries.increment();
                 if (aaIt->second->getAAResults().alias(load->getPointerOperand(), store->getPointerOperand()) >= AliasResult::PartialAlias) {
                     has = true;
                     range = range.unionWith(computeConstantRangeFor(store->getValueOperand(), store, valueSet).sextOrTrunc(bitWidth));
@@ -217,10 +206,7 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Value* V, const Instruc
             return ConstantRange::getFull(range.getBitWidth());
         }
     } else {
-#if 1
-        LOG(LOG_INFO, "Constant range inference failed: " << C->getFunction()->getName() << "\n");
-        V->dump();
-#endif
+        LOG(LOG_DEBUG, "Constant range inference failed: " << C->getFunction()->getName() << "\n" << *V << "\n");
     }
 
     return range;
@@ -247,12 +233,12 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Function* function, Val
 
     if (/*constantRange.isEmptySet() || */constantRange.isFullSet()) {
         auto uniqueInterval = getUniqueInterval(allIntervals, make_pair(function, 0));
-        LOG(LOG_INFO, "unique interval case for full-set of: " << function->getName() << "\n");
+        LOG(LOG_DEBUG, "unique interval case for full-set of: " << function->getName() << "\n");
         if (uniqueInterval) {
             constantRange = ConstantRange(APInt(constantRange.getBitWidth(), uniqueInterval->lowest()),
                                           APInt(constantRange.getBitWidth(),
                                                 uniqueInterval->highest() < INT_MAX ? static_cast<long>(uniqueInterval->highest()) + 1L : INT_MAX));
-            constantRange.dump();
+            LOG(LOG_DEBUG, constantRange << "\n");
         }
     }
 
@@ -260,10 +246,8 @@ ConstantRange FunctionVSA::computeConstantRangeFor(const Function* function, Val
     if (it == functionToRange.end()) {
         functionToRange.emplace(function, constantRange);
     } else {
-        LOG(LOG_INFO, "RANGE: ");
         it->second = constantRange;
-        functionToRange.find(function)->second.dump();
-        LOG(LOG_INFO, "\n");
+        LOG(LOG_DEBUG, "RANGE: " << constantRange << "\n");
     }
     return constantRange;
 }
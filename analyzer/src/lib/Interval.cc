@@ -1,6 +1,7 @@
 #include "Interval.h"
 #include "Common.h"
 #include <limits>
+#include <tuple>
 
 void Range::dump() const {
     LOG(LOG_INFO, "[" << low << ", " << high << "]");
@@ -10,6 +11,10 @@ bool Range::operator==(const Range& other) const {
     return low == other.low && high == other.high;
 }
 
+bool Range::operator<(const Range& other) const {
+    return std::tie(low, high) < std::tie(other.low, other.high);
+}
+
 size_t Range::size() const {
     return static_cast<long>(high) - static_cast<long>(low) + 1L;
 }
@@ -175,11 +180,25 @@ Interval Interval::union_(const Interval& other) const {
 }
 
 void Interval::unionInPlace(const Interval& other) {
+    // Fast paths that avoid building a temporary
+    if (other.empty() || full())
+        return;
+    if (empty() || other.full()) {
+        ranges = other.ranges;
+        return;
+    }
     auto union__ = union_(other);
     ranges = std::move(union__.ranges);
 }
 
 void Interval::intersectionInPlace(const Interval& other) {
+    // Fast paths that avoid building a temporary
+    if (empty() || other.full())
+        return;
+    if (other.empty() || full()) {
+        ranges = other.ranges;
+        return;
+    }
     auto intersection_ = intersection(other);
     ranges = std::move(intersection_.ranges);
 }
@@ -268,6 +287,10 @@ bool Interval::operator==(const Interval& other) const {
     return true;
 }
 
+bool Interval::operator<(const Interval& other) const {
+    return std::lexicographical_compare(ranges.begin(), ranges.end(), other.ranges.begin(), other.ranges.end());
+}
+
 
 int Interval::lowest() const {
     if (ranges.empty()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/Instructions.h>
 
@@ -37,6 +38,7 @@ struct Range {
     [[nodiscard]] size_t size() const;
 
     bool operator==(const Range& other) const;
+    bool operator<(const Range& other) const;
 };
 
 struct IntervalHash;
@@ -54,6 +56,7 @@ public:
         return ranges.size() == 1 && ranges[0].low == INT_MIN && ranges[0].high == INT_MAX;
     }
     void appendUnsafeBecauseExpectsSortMaintained(Range range);
+    [[nodiscard]] inline llvm::ArrayRef<Range> getRanges() const { return ranges; }
     [[nodiscard]] Interval intersection(const Interval& other) const;
     [[nodiscard]] Interval union_(const Interval& other) const;
     void unionInPlace(const Interval& other);
@@ -71,6 +74,8 @@ public:
     [[nodiscard]] int signedness() const;
 
     bool operator==(const Interval& other) const;
+    // Lexicographic order on the ranges, only used to visit intervals in a canonical order
+    bool operator<(const Interval& other) const;
 
 private:
     // Invariant: this is sorted and disjoint!
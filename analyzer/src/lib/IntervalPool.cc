@@ -0,0 +1,116 @@
+#include "IntervalPool.h"
+#include <mutex>
+
+IntervalPool& IntervalPool::get() {
+    static IntervalPool pool;
+    return pool;
+}
+
+IntervalPool::IntervalPool() : emptyRef(internLocked(Interval {true})), fullRef(internLocked(Interval {false})) {
+}
+
+IntervalRef IntervalPool::internLocked(Interval&& interval) {
+    auto it = index.find_as(interval);
+    if (it != index.end())
+        return IntervalRef {*it};
+    auto hash = IntervalHash()(interval);
+    const auto* node = &storage.emplace_back(InternedInterval {std::move(interval), hash});
+    index.insert(node);
+    return IntervalRef {node};
+}
+
+IntervalRef IntervalPool::intern(const Interval& interval) {
+    {
+        std::shared_lock _(lock);
+        auto it = index.find_as(interval);
+        if (it != index.end())
+            return IntervalRef {*it};
+    }
+    Interval copy = interval;
+    std::unique_lock _(lock);
+    return internLocked(std::move(copy));
+}
+
+IntervalRef IntervalPool::intern(Interval&& interval) {
+    {
+        std::shared_lock _(lock);
+        auto it = index.find_as(interval);
+        if (it != index.end())
+            return IntervalRef {*it};
+    }
+    std::unique_lock _(lock);
+    return internLocked(std::move(interval));
+}
+
+template<typename Key, typename Compute>
+IntervalRef IntervalPool::memoized(llvm::DenseMap<Key, const InternedInterval*>& memo, const Key& key, Compute compute) {
+    {
+        std::shared_lock _(lock);
+        auto it = memo.find(key);
+        if (it != memo.end())
+            return IntervalRef {it->second};
+    }
+    // Compute outside the lock, the operands are immutable.
+    Interval result = compute();
+    std::unique_lock _(lock);
+    auto ref = internLocked(std::move(result));
+    memo.try_emplace(key, ref.node);
+    return ref;
+}
+
+IntervalRef IntervalPool::fromPredicate(llvm::ICmpInst::Predicate predicate, int rhs) {
+    return memoized(predicateMemo, std::make_pair(static_cast<unsigned int>(predicate), rhs), [&]() {
+        Interval interval(false);
+        interval.applyInequalityOperator(predicate, rhs);
+        return interval;
+    });
+}
+
+IntervalRef IntervalPool::singleton(int value) {
+    return fromPredicate(llvm::ICmpInst::Predicate::ICMP_EQ, value);
+}
+
+IntervalRef IntervalPool::intersection(IntervalRef a, IntervalRef b) {
+    // Fast paths that do not need the memo table
+    if (a == b || b == fullRef || a == emptyRef)
+        return a;
+    if (a == fullRef || b == emptyRef)
+        return b;
+    if (b.node < a.node)
+        std::swap(a, b);
+    return memoized(intersectionMemo, std::make_pair(a.node, b.node), [&]() {
+        return a->intersection(*b);
+    });
+}
+
+IntervalRef IntervalPool::union_(IntervalRef a, IntervalRef b) {
+    // Fast paths that do not need the memo table
+    if (a == b || b == emptyRef || a == fullRef)
+        return a;
+    if (a == emptyRef || b == fullRef)
+        return b;
+    if (b.node < a.node)
+        std::swap(a, b);
+    return memoized(unionMemo, std::make_pair(a.node, b.node), [&]() {
+        return a->union_(*b);
+    });
+}
+
+IntervalRef IntervalPool::complement(IntervalRef a) {
+    if (a == emptyRef)
+        return fullRef;
+    if (a == fullRef)
+        return emptyRef;
+    return memoized(complementMemo, a.node, [&]() {
+        return a->complement();
+    });
+}
+
+bool IntervalPool::isSubsetOf(IntervalRef a, IntervalRef b) {
+    return intersection(a, b) == a;
+}
+
+size_t IntervalPool::size() const {
+    std::shared_lock _(lock);
+    return storage.size();
+}
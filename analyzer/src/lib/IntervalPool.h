@@ -0,0 +1,99 @@
+#pragma once
+
+#include <deque>
+#include <shared_mutex>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include "Interval.h"
+
+// An interned, immutable interval. Only the pool creates these, so two equal intervals always share one node.
+struct InternedInterval {
+    Interval interval;
+    size_t hash;
+};
+
+// Handle to an interned interval: equality and hashing are O(1).
+// The hash is the content hash (IntervalHash), such that hash-based containers keyed on handles iterate in the same
+// order as containers keyed on the intervals themselves.
+class IntervalRef {
+public:
+    [[nodiscard]] inline const Interval& operator*() const { return node->interval; }
+    [[nodiscard]] inline const Interval* operator->() const { return &node->interval; }
+    [[nodiscard]] inline size_t hash() const { return node->hash; }
+    [[nodiscard]] inline const InternedInterval* getNode() const { return node; }
+
+    inline bool operator==(const IntervalRef& other) const { return node == other.node; }
+    inline bool operator!=(const IntervalRef& other) const { return node != other.node; }
+
+private:
+    explicit IntervalRef(const InternedInterval* node) : node(node) {}
+
+    const InternedInterval* node;
+
+    friend class IntervalPool;
+};
+
+struct IntervalRefHash {
+    size_t operator()(const IntervalRef& ref) const {
+        return ref.hash();
+    }
+};
+
+/**
+ * Process-wide hash-consing pool for intervals.
+ * Binary operations on handles are memoized, so the handful of intervals that dominate real runs
+ * (e.g. [INT_MIN, -1], [0, 0] and != 0) are only ever computed and allocated once.
+ * All operations are thread-safe.
+ */
+class IntervalPool {
+public:
+    static IntervalPool& get();
+
+    IntervalRef intern(const Interval& interval);
+    IntervalRef intern(Interval&& interval);
+
+    [[nodiscard]] inline IntervalRef empty() const { return emptyRef; }
+    [[nodiscard]] inline IntervalRef full() const { return fullRef; }
+
+    // The full interval restricted by "x <predicate> rhs".
+    IntervalRef fromPredicate(llvm::ICmpInst::Predicate predicate, int rhs);
+    IntervalRef singleton(int value);
+
+    IntervalRef intersection(IntervalRef a, IntervalRef b);
+    IntervalRef union_(IntervalRef a, IntervalRef b);
+    IntervalRef complement(IntervalRef a);
+    bool isSubsetOf(IntervalRef a, IntervalRef b);
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    IntervalPool();
+
+    struct NodeInfo {
+        static inline const InternedInterval* getEmptyKey() { return llvm::DenseMapInfo<const InternedInterval*>::getEmptyKey(); }
+        static inline const InternedInterval* getTombstoneKey() { return llvm::DenseMapInfo<const InternedInterval*>::getTombstoneKey(); }
+        static unsigned getHashValue(const InternedInterval* node) { return static_cast<unsigned>(node->hash); }
+        static unsigned getHashValue(const Interval& interval) { return static_cast<unsigned>(IntervalHash()(interval)); }
+        static bool isEqual(const InternedInterval* a, const InternedInterval* b) { return a == b; }
+        static bool isEqual(const Interval& a, const InternedInterval* b) {
+            return b != getEmptyKey() && b != getTombstoneKey() && a == b->interval;
+        }
+    };
+
+    using NodePair = std::pair<const InternedInterval*, const InternedInterval*>;
+
+    IntervalRef internLocked(Interval&& interval);
+    template<typename Key, typename Compute>
+    IntervalRef memoized(llvm::DenseMap<Key, const InternedInterval*>& memo, const Key& key, Compute compute);
+
+    mutable std::shared_mutex lock;
+    std::deque<InternedInterval> storage;
+    llvm::DenseSet<const InternedInterval*, NodeInfo> index;
+
+    llvm::DenseMap<NodePair, const InternedInterval*> intersectionMemo;
+    llvm::DenseMap<NodePair, const InternedInterval*> unionMemo;
+    llvm::DenseMap<const InternedInterval*, const InternedInterval*> complementMemo;
+    llvm::DenseMap<std::pair<unsigned int, int>, const InternedInterval*> predicateMemo;
+
+    IntervalRef emptyRef, fullRef;
+};
@@ -0,0 +1,72 @@
+#include <optional>
+#include <llvm/Support/ThreadPool.h>
+
+#include "Analyzer.h"
+#include "ClOptForward.h"
+#include "Statistics.h"
+#include "Trace.h"
+
+void IterativeModulePass::run(const std::vector<llvm::Module *> &modules, bool multithreaded) {
+  OP << "[" << ID << "] Initializing " << modules.size() << " modules ";
+  bool again = true;
+  optional<PhaseTimer> phase(std::in_place, "initialization");
+  if (multithreaded && ThreadCount > 1 && initializesConcurrently()) {
+    Log::flush();
+    ThreadPool threadPool(hardware_concurrency(ThreadCount));
+    for (auto *module : modules) {
+      threadPool.async([this, module]() {
+        {
+          Trace::Span span(string(ID) + " initialization", module->getModuleIdentifier());
+          doInitialization(module);
+        }
+        Log::flush();
+      });
+    }
+    threadPool.wait();
+    OP << string(modules.size(), '.');
+  } else {
+    while (again) {
+      again = false;
+      for (auto *module : modules) {
+        again |= doInitialization(module);
+        OP << ".";
+      }
+    }
+  }
+  OP << "\n";
+
+  {
+    phase.emplace("module pass");
+    OP << "[" << ID << " / " << 1 << "] ";
+
+    if (multithreaded && ThreadCount > 1) {
+        Log::flush();
+        ThreadPool threadPool(hardware_concurrency(ThreadCount));
+        for (auto *module : modules) {
+            threadPool.async([this, module]() {
+                _doModulePass(module);
+                Log::flush();
+            });
+        }
+        threadPool.wait();
+    } else {
+        for (auto *module : modules) {
+            _doModulePass(module);
+        }
+    }
+
+    //OP << "[" << ID << "] Updated in " << changed << " modules.\n";
+  }
+
+  OP << "[" << ID << "] Postprocessing ...\n";
+  phase.emplace("postprocessing");
+  again = true;
+  while (again) {
+    again = false;
+    for (auto *m : modules) {
+      again |= doFinalization(m);
+    }
+  }
+
+  OP << "[" << ID << "] Done!\n\n";
+}
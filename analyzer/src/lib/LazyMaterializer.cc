@@ -0,0 +1,105 @@
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalAlias.h>
+#include <llvm/IR/InstIterator.h>
+#include "LazyMaterializer.h"
+#include "Common.h"
+
+LazyMaterializer::LazyMaterializer(const std::vector<Module*>& eagerModules, const std::vector<Module*>& lazyModules)
+    : eagerModules(eagerModules), lazyModules(lazyModules) {
+}
+
+void LazyMaterializer::run() {
+    for (auto* module : lazyModules) {
+        for (auto& global : module->global_values()) {
+            if (!global.isDeclaration() && !global.hasLocalLinkage())
+                lazyDefinitions[global.getName()].push_back(&global);
+        }
+    }
+
+    // Everything an eager module declares might be defined lazily
+    for (const auto* module : eagerModules) {
+        for (const auto& function : *module) {
+            if (function.isDeclaration() && !function.isIntrinsic())
+                enqueueByName(function.getName());
+        }
+        for (const auto& global : module->globals()) {
+            if (global.isDeclaration())
+                enqueueByName(global.getName());
+        }
+    }
+
+    while (!worklist.empty()) {
+        auto* function = worklist.back();
+        worklist.pop_back();
+        if (auto error = function->materialize()) {
+            OP << "Failed to materialize " << function->getName() << ": " << toString(std::move(error)) << "\n";
+            continue;
+        }
+        ++materializedCount;
+        scanFunctionBody(function);
+    }
+
+    for (const auto* module : lazyModules) {
+        deferredCount += count_if(*module, [](const Function& function) { return function.isMaterializable(); });
+    }
+}
+
+void LazyMaterializer::materializeOnFirstVisit(Module* module) {
+    if (module->isMaterialized())
+        return;
+    if (auto error = module->materializeAll())
+        OP << "Failed to materialize " << module->getName() << ": " << toString(std::move(error)) << "\n";
+}
+
+void LazyMaterializer::enqueueByName(StringRef name) {
+    auto it = lazyDefinitions.find(name);
+    if (it == lazyDefinitions.end())
+        return;
+    for (const auto* global : it->second)
+        enqueueValue(global);
+}
+
+void LazyMaterializer::enqueueValue(const Value* value) {
+    auto global = dyn_cast<GlobalValue>(value);
+    if (!global || !visited.insert(global).second)
+        return;
+
+    if (auto alias = dyn_cast<GlobalAlias>(global)) {
+        scanConstant(alias->getAliasee());
+    } else if (auto function = dyn_cast<Function>(global)) {
+        if (function->isMaterializable())
+            worklist.push_back(const_cast<Function*>(function));
+        else if (function->isDeclaration())
+            enqueueByName(function->getName());
+    } else if (auto variable = dyn_cast<GlobalVariable>(global)) {
+        if (variable->hasInitializer())
+            scanConstant(variable->getInitializer());
+        else
+            enqueueByName(variable->getName());
+    }
+}
+
+void LazyMaterializer::scanConstant(const Constant* constant) {
+    if (auto global = dyn_cast<GlobalValue>(constant)) {
+        enqueueValue(global);
+        return;
+    }
+    if (!visited.insert(constant).second)
+        return;
+    // Function tables and casts
+    for (const auto& operand : constant->operands()) {
+        if (auto operandConstant = dyn_cast<Constant>(operand))
+            scanConstant(operandConstant);
+    }
+}
+
+void LazyMaterializer::scanFunctionBody(Function* function) {
+    if (function->hasPersonalityFn())
+        scanConstant(function->getPersonalityFn());
+    for (const auto& instruction : instructions(function)) {
+        for (const auto& operand : instruction.operands()) {
+            if (auto constant = dyn_cast<Constant>(operand))
+                scanConstant(constant);
+        }
+    }
+}
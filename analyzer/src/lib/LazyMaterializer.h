@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/Module.h>
+
+/**
+ * Materializes the function bodies of lazily loaded modules that are reachable from the eagerly loaded modules while
+ * loading. Roots are the functions declared in eager modules, reachability follows calls and address-taken functions,
+ * including those referenced from global initializers. The unreached bodies stay materializable and are only loaded
+ * when the analysis first visits their module, see materializeOnFirstVisit(). So every body is analyzed, and the
+ * results are the same as when loading the modules eagerly.
+ */
+class LazyMaterializer {
+public:
+    LazyMaterializer(const std::vector<llvm::Module*>& eagerModules, const std::vector<llvm::Module*>& lazyModules);
+
+    void run();
+
+    // Loads the bodies of a lazily loaded module that were not reached while loading, nothing for other modules
+    static void materializeOnFirstVisit(llvm::Module* module);
+
+    [[nodiscard]] inline size_t getMaterializedCount() const { return materializedCount; }
+    [[nodiscard]] inline size_t getDeferredCount() const { return deferredCount; }
+
+private:
+    void enqueueByName(llvm::StringRef name);
+    void enqueueValue(const llvm::Value* value);
+    void scanConstant(const llvm::Constant* constant);
+    void scanFunctionBody(llvm::Function* function);
+
+    const std::vector<llvm::Module*>& eagerModules;
+    const std::vector<llvm::Module*>& lazyModules;
+
+    // Definitions with non-local linkage of the lazy modules, by name
+    llvm::StringMap<std::vector<llvm::GlobalValue*>> lazyDefinitions;
+    llvm::DenseSet<const llvm::Value*> visited;
+    std::vector<llvm::Function*> worklist;
+    size_t materializedCount = 0, deferredCount = 0;
+};
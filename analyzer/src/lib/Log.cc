@@ -0,0 +1,86 @@
+#include <mutex>
+#include <string>
+#include "Log.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace Log {
+
+// Buffered lines are written out once the buffer holds this many bytes
+static constexpr size_t FlushThreshold = 64 * 1024;
+
+static mutex WriteLock;
+
+static void writeToStderr(const char* data, size_t size) {
+    lock_guard<mutex> guard(WriteLock);
+    // errs() is unbuffered, this is a single write
+    errs().write(data, size);
+}
+
+class ThreadBuffer : public raw_ostream {
+public:
+    // Unbuffered, the lines are collected in our own buffer instead
+    ThreadBuffer() : raw_ostream(true) {}
+
+    ~ThreadBuffer() override {
+        flushAll();
+    }
+
+    void flushAll() {
+        if (!buffer.empty()) {
+            writeToStderr(buffer.data(), buffer.size());
+            written += buffer.size();
+            buffer.clear();
+        }
+    }
+
+    void flushUnlocked() {
+        // The crashing thread might hold the lock already
+        errs().write(buffer.data(), buffer.size());
+        written += buffer.size();
+        buffer.clear();
+    }
+
+private:
+    void write_impl(const char* ptr, size_t size) override {
+        buffer.append(ptr, size);
+        if (buffer.size() >= FlushThreshold)
+            flushCompleteLines();
+    }
+
+    uint64_t current_pos() const override {
+        return written + buffer.size();
+    }
+
+    void flushCompleteLines() {
+        auto end = buffer.rfind('\n');
+        if (end == string::npos)
+            return;
+        writeToStderr(buffer.data(), end + 1);
+        written += end + 1;
+        buffer.erase(0, end + 1);
+    }
+
+    string buffer;
+    uint64_t written = 0;
+};
+
+static ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+raw_ostream& stream() {
+    return threadBuffer();
+}
+
+void flush() {
+    threadBuffer().flushAll();
+}
+
+void flushOnCrash() {
+    threadBuffer().flushUnlocked();
+}
+
+}
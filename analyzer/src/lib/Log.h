@@ -0,0 +1,23 @@
+#pragma once
+
+#include <llvm/Support/raw_ostream.h>
+
+/**
+ * Sink of the log output (LOG and OP). Every thread writes into its own buffer, which goes to stderr in whole lines,
+ * with a single write, once it grows past a threshold, on flush() and when the thread exits. The writes of different
+ * threads are serialized, so their lines never interleave.
+ * Tasks on the thread pools flush at their end, and the main thread flushes before it hands out tasks, such that the
+ * output of a parallel phase stays in order with the output around it.
+ */
+namespace Log {
+
+// The buffered stream of the current thread
+llvm::raw_ostream& stream();
+
+// Writes out everything the current thread has buffered
+void flush();
+
+// Like flush(), but without waiting for the other threads, for signal handlers
+void flushOnCrash();
+
+}
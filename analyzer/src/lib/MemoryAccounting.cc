@@ -0,0 +1,48 @@
+#include <llvm/IR/Instructions.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Process.h>
+#include "MemoryAccounting.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace MemoryAccounting {
+
+size_t approximateIRBytes(const Module& module) {
+    size_t bytes = sizeof(Module);
+    for (const auto& function : module) {
+        bytes += sizeof(Function) + function.arg_size() * sizeof(Argument);
+        for (const auto& block : function) {
+            bytes += sizeof(BasicBlock);
+            for (const auto& instruction : block) {
+                // Calls are the largest of the common instructions, others are smaller
+                bytes += (isa<CallBase>(instruction) ? sizeof(CallInst) : sizeof(Instruction))
+                         + instruction.getNumOperands() * sizeof(Use);
+            }
+        }
+    }
+    bytes += module.global_size() * sizeof(GlobalVariable);
+    return bytes;
+}
+
+void MemoryReport::add(StringRef name, size_t entries, size_t bytes) {
+    rows.push_back(Row {name.str(), entries, bytes});
+}
+
+static double toMiB(size_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void MemoryReport::print(raw_ostream& out) const {
+    size_t total = 0;
+    out << "===== Memory after " << phase << " =====\n";
+    out << "      Entries   Size (MiB)  Structure\n";
+    for (const auto& row : rows) {
+        out << format("%13zu %12.2f", row.entries, toMiB(row.bytes)) << "  " << row.name << "\n";
+        total += row.bytes;
+    }
+    out << format("%26.2f", toMiB(total)) << "  Total of the above\n";
+    out << format("%26.2f", toMiB(sys::Process::GetMallocUsage())) << "  Heap in use (malloc)\n";
+}
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Interval.h"
+
+/**
+ * Approximate memory accounting of the analysis data structures, see --account-memory.
+ * HeapBytes<T>::of(value) estimates the heap memory owned by a value beyond sizeof(T), following the usual layout of
+ * the standard and LLVM containers. Values of other types are assumed to own no heap memory, and pointees of raw
+ * pointers are not followed.
+ */
+namespace MemoryAccounting {
+
+// Per node overhead of node-based standard containers: the links (and the color or cached hash)
+constexpr size_t TreeNodeOverhead = 4 * sizeof(void*);
+constexpr size_t HashNodeOverhead = 2 * sizeof(void*);
+
+template<typename T>
+struct HeapBytes {
+    static size_t of(const T&) { return 0; }
+};
+
+template<typename Container>
+size_t elementHeapBytes(const Container& container) {
+    size_t bytes = 0;
+    for (const auto& element : container)
+        bytes += HeapBytes<std::decay_t<decltype(element)>>::of(element);
+    return bytes;
+}
+
+template<>
+struct HeapBytes<std::string> {
+    static size_t of(const std::string& string) {
+        // Short strings are stored inline
+        return string.capacity() > 15 ? string.capacity() + 1 : 0;
+    }
+};
+
+template<>
+struct HeapBytes<Interval> {
+    static size_t of(const Interval& interval) {
+        // Up to two ranges are stored inline
+        auto ranges = interval.getRanges().size();
+        return ranges > 2 ? ranges * sizeof(Range) : 0;
+    }
+};
+
+template<typename A, typename B>
+struct HeapBytes<std::pair<A, B>> {
+    static size_t of(const std::pair<A, B>& pair) {
+        return HeapBytes<std::decay_t<A>>::of(pair.first) + HeapBytes<std::decay_t<B>>::of(pair.second);
+    }
+};
+
+template<typename T>
+struct HeapBytes<std::optional<T>> {
+    static size_t of(const std::optional<T>& optional) {
+        return optional ? HeapBytes<T>::of(*optional) : 0;
+    }
+};
+
+template<typename T, typename Allocator>
+struct HeapBytes<std::vector<T, Allocator>> {
+    static size_t of(const std::vector<T, Allocator>& vector) {
+        return vector.capacity() * sizeof(T) + elementHeapBytes(vector);
+    }
+};
+
+template<typename T, typename Allocator>
+struct HeapBytes<std::deque<T, Allocator>> {
+    static size_t of(const std::deque<T, Allocator>& deque) {
+        return deque.size() * sizeof(T) + elementHeapBytes(deque);
+    }
+};
+
+template<typename T, unsigned N>
+struct HeapBytes<llvm::SmallVector<T, N>> {
+    static size_t of(const llvm::SmallVector<T, N>& vector) {
+        return (vector.capacity() > N ? vector.capacity() * sizeof(T) : 0) + elementHeapBytes(vector);
+    }
+};
+
+template<typename T, unsigned N>
+struct HeapBytes<llvm::SmallPtrSet<T, N>> {
+    static size_t of(const llvm::SmallPtrSet<T, N>& set) {
+        // Large sets are hash tables that are kept at most 3/4 full
+        return set.size() > N ? llvm::PowerOf2Ceil(set.size() * 4 / 3 + 1) * sizeof(void*) : 0;
+    }
+};
+
+template<typename K, typename V, typename Compare, typename Allocator>
+struct HeapBytes<std::map<K, V, Compare, Allocator>> {
+    static size_t of(const std::map<K, V, Compare, Allocator>& map) {
+        return map.size() * (sizeof(std::pair<const K, V>) + TreeNodeOverhead) + elementHeapBytes(map);
+    }
+};
+
+template<typename T, typename Compare, typename Allocator>
+struct HeapBytes<std::set<T, Compare, Allocator>> {
+    static size_t of(const std::set<T, Compare, Allocator>& set) {
+        return set.size() * (sizeof(T) + TreeNodeOverhead) + elementHeapBytes(set);
+    }
+};
+
+template<typename K, typename V, typename Hash, typename Equal, typename Allocator>
+struct HeapBytes<std::unordered_map<K, V, Hash, Equal, Allocator>> {
+    static size_t of(const std::unordered_map<K, V, Hash, Equal, Allocator>& map) {
+        return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(std::pair<const K, V>) + HashNodeOverhead)
+               + elementHeapBytes(map);
+    }
+};
+
+template<typename T, typename Hash, typename Equal, typename Allocator>
+struct HeapBytes<std::unordered_set<T, Hash, Equal, Allocator>> {
+    static size_t of(const std::unordered_set<T, Hash, Equal, Allocator>& set) {
+        return set.bucket_count() * sizeof(void*) + set.size() * (sizeof(T) + HashNodeOverhead) + elementHeapBytes(set);
+    }
+};
+
+template<typename K, typename V, typename KeyInfo, typename Bucket>
+struct HeapBytes<llvm::DenseMap<K, V, KeyInfo, Bucket>> {
+    static size_t of(const llvm::DenseMap<K, V, KeyInfo, Bucket>& map) {
+        size_t bytes = map.getMemorySize();
+        for (const auto& [key, value] : map)
+            bytes += HeapBytes<K>::of(key) + HeapBytes<V>::of(value);
+        return bytes;
+    }
+};
+
+template<typename T, typename KeyInfo>
+struct HeapBytes<llvm::DenseSet<T, KeyInfo>> {
+    static size_t of(const llvm::DenseSet<T, KeyInfo>& set) {
+        return set.getMemorySize() + elementHeapBytes(set);
+    }
+};
+
+// Approximate size of a container, including the container object itself.
+template<typename T>
+size_t approximateBytes(const T& container) {
+    return sizeof(T) + HeapBytes<T>::of(container);
+}
+
+// Approximate size of the in-memory IR of a module: functions, blocks and instructions with their operands.
+// Metadata, constants and types are owned by the LLVMContext and not included.
+size_t approximateIRBytes(const llvm::Module& module);
+
+// Table of data structure sizes after a phase of the analysis.
+class MemoryReport {
+public:
+    explicit MemoryReport(llvm::StringRef phase) : phase(phase.str()) {}
+
+    template<typename T>
+    void add(llvm::StringRef name, const T& container) {
+        add(name, container.size(), approximateBytes(container));
+    }
+
+    void add(llvm::StringRef name, size_t entries, size_t bytes);
+
+    void print(llvm::raw_ostream& out) const;
+
+private:
+    struct Row {
+        std::string name;
+        size_t entries;
+        size_t bytes;
+    };
+
+    std::string phase;
+    std::vector<Row> rows;
+};
+
+}
@@ -0,0 +1,52 @@
+#include "MemoryBudget.h"
+#include <algorithm>
+#include <llvm/Support/Format.h>
+
+void MemoryBudget::acquire(uint64_t bytes) {
+    std::unique_lock guard(lock);
+    auto fits = [&]() {
+        return budget == 0 || reserved == resident || reserved + bytes <= budget;
+    };
+    if (!fits()) {
+        ++waitCount;
+        released.wait(guard, fits);
+    }
+    if (budget > 0 && reserved + bytes > budget)
+        ++overBudgetCount;
+    reserved += bytes;
+    peakReserved = std::max(peakReserved, reserved);
+    totalReserved += bytes;
+    ++admittedCount;
+}
+
+void MemoryBudget::release(uint64_t bytes) {
+    {
+        std::lock_guard _(lock);
+        reserved -= bytes;
+    }
+    released.notify_all();
+}
+
+void MemoryBudget::makeResident(uint64_t bytes) {
+    {
+        std::lock_guard _(lock);
+        resident += bytes;
+    }
+    released.notify_all();
+}
+
+static double toMiB(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void MemoryBudget::printStatistics(llvm::raw_ostream& out) const {
+    std::lock_guard _(lock);
+    out << "Memory budget: admitted " << admittedCount << " job(s) totalling " << llvm::format("%.1f", toMiB(totalReserved))
+        << " MiB, peak " << llvm::format("%.1f", toMiB(peakReserved)) << " MiB";
+    if (budget > 0)
+        out << " of " << llvm::format("%.1f", toMiB(budget)) << " MiB";
+    else
+        out << " (unlimited)";
+    out << ", " << llvm::format("%.1f", toMiB(resident)) << " MiB resident, " << waitCount << " job(s) waited, "
+        << overBudgetCount << " job(s) admitted over budget\n";
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <llvm/Support/raw_ostream.h>
+
+/**
+ * Admission control for memory-heavy work such as parsing modules.
+ * Each job reserves its estimated size before it starts and blocks while the reservation would exceed the budget.
+ * A job whose result stays in memory, such as a loaded module, keeps its reservation as resident once it finished.
+ * A job that does not fit is still admitted once no other job is running, so loading always progresses even when the
+ * resident results alone exhaust the budget; such jobs are counted as over budget.
+ * A budget of 0 admits everything, the accounting is kept either way.
+ */
+class MemoryBudget {
+public:
+    explicit MemoryBudget(uint64_t budget) : budget(budget) {}
+
+    void acquire(uint64_t bytes);
+    void release(uint64_t bytes);
+    // Keeps the reservation of a finished job for as long as the budget exists
+    void makeResident(uint64_t bytes);
+
+    void printStatistics(llvm::raw_ostream& out) const;
+
+private:
+    const uint64_t budget;
+
+    mutable std::mutex lock;
+    std::condition_variable released;
+    uint64_t reserved = 0;
+    uint64_t resident = 0;
+    uint64_t peakReserved = 0;
+    uint64_t totalReserved = 0;
+    unsigned int admittedCount = 0;
+    unsigned int waitCount = 0;
+    unsigned int overBudgetCount = 0;
+};
+
+// Scoped reservation on a memory budget, unless it is kept as resident.
+class MemoryReservation {
+public:
+    MemoryReservation(MemoryBudget& budget, uint64_t bytes) : budget(budget), bytes(bytes) {
+        budget.acquire(bytes);
+    }
+
+    ~MemoryReservation() {
+        if (!resident)
+            budget.release(bytes);
+    }
+
+    void keepResident() {
+        if (!resident)
+            budget.makeResident(bytes);
+        resident = true;
+    }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+private:
+    MemoryBudget& budget;
+    const uint64_t bytes;
+    bool resident = false;
+};
@@ -0,0 +1,42 @@
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+#include "ModulePartitioner.h"
+#include "AnalysisCache.h"
+#include "Common.h"
+
+static bool hasDefinitions(const Module& module) {
+    return any_of(module.global_values(), [](const GlobalValue& global) {
+        return !global.isDeclaration();
+    });
+}
+
+vector<ModulePartition> partitionModule(unique_ptr<Module> module, unsigned int count, bool computeContentHashes) {
+    vector<SmallString<0>> bitcodes;
+    string name = module->getModuleIdentifier();
+    SplitModule(*module, count, [&](unique_ptr<Module> partition) {
+        if (!hasDefinitions(*partition))
+            return;
+        raw_svector_ostream out(bitcodes.emplace_back());
+        WriteBitcodeToFile(*partition, out);
+    }, /* PreserveLocals */ true);
+    auto& context = module->getContext();
+    module.reset();
+    delete &context;
+
+    vector<ModulePartition> partitions;
+    for (unsigned int i = 0; i < bitcodes.size(); ++i) {
+        SMDiagnostic error;
+        auto partitionContext = new LLVMContext();
+        auto partitionName = name + "#" + to_string(i);
+        auto partition = parseIR(MemoryBufferRef(bitcodes[i], partitionName), error, *partitionContext);
+        if (!partition) {
+            OP << "error re-reading partition " << partitionName << ": " << error.getMessage() << "\n";
+            delete partitionContext;
+            continue;
+        }
+        partitions.push_back({std::move(partition), computeContentHashes ? computeContentHash(bitcodes[i]) : ""});
+    }
+    return partitions;
+}
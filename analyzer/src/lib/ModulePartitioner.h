@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <llvm/IR/Module.h>
+
+struct ModulePartition {
+    std::unique_ptr<llvm::Module> module;
+    // Content hash of the partition's bitcode, identifies the partition like the content hash of an input file.
+    // Empty unless requested.
+    std::string contentHash;
+};
+
+/**
+ * Splits a module into at most count partitions, such that the per-module passes can process a single combined input
+ * (e.g. from extract-bc) in parallel. Functions and globals that share a symbol with local linkage stay in the same
+ * partition, so linkage and names are unchanged and the partitions look like separately compiled translation units.
+ * Every partition is re-created in its own LLVMContext, because the passes analyze modules concurrently.
+ * Partitions without any definition are omitted.
+ */
+std::vector<ModulePartition> partitionModule(std::unique_ptr<llvm::Module> module, unsigned int count, bool computeContentHashes);
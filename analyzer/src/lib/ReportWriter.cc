@@ -0,0 +1,232 @@
+#include <memory>
+#include <mutex>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Interval.h"
+#include "ReportWriter.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace ReportWriter {
+
+struct Rule {
+    StringRef id;
+    StringRef level;
+    StringRef description;
+};
+
+static const Rule Rules[] = {
+    {"error-specification", "note", "Learned error specification: the error values a function returns"},
+    {"safety-check", "note", "Safety check found using similarities"},
+    {"missing-check", "warning", "Missing check of the error values of a call"},
+    {"incorrect-check", "warning", "Not all error values of a call are checked"},
+    {"truncation", "warning", "Error values are truncated"},
+    {"signedness", "warning", "Error values have another signedness than those of the other functions of the same return type"},
+};
+
+static bool Enabled = false;
+static Format OutputFormat;
+static mutex WriteLock;
+static unique_ptr<raw_fd_ostream> Out;
+// For SARIF, the document stays open while the results are streamed into it
+static unique_ptr<json::OStream> Document;
+
+Location Location::of(const Instruction* instruction, bool followInlines) {
+    Location location;
+    const auto& debugLocation = instruction->getDebugLoc();
+    if (auto node = debugLocation.get(); node && debugLocation.getLine() >= 1) {
+        location.file = node->getFilename();
+        location.line = debugLocation.getLine();
+        if (auto inlinedAt = followInlines ? node->getInlinedAt() : nullptr) {
+            location.inlinedAtFile = inlinedAt->getFilename();
+            location.inlinedAtLine = inlinedAt->getLine();
+        }
+    } else {
+        location = of(instruction->getFunction());
+    }
+    return location;
+}
+
+Location Location::of(const Function* function) {
+    Location location;
+    if (auto subProgram = function->getSubprogram()) {
+        location.file = subProgram->getFilename();
+        location.line = subProgram->getLine();
+        location.approximate = true;
+    }
+    return location;
+}
+
+bool open(StringRef path, Format format, string& error) {
+    error_code errorCode;
+    Out = make_unique<raw_fd_ostream>(path, errorCode);
+    if (errorCode) {
+        error = errorCode.message();
+        Out.reset();
+        return false;
+    }
+    Enabled = true;
+    OutputFormat = format;
+    if (format == Format::SARIF) {
+        Document = make_unique<json::OStream>(*Out);
+        Document->objectBegin();
+        Document->attribute("$schema", "https://json.schemastore.org/sarif-2.1.0.json");
+        Document->attribute("version", "2.1.0");
+        Document->attributeBegin("runs");
+        Document->arrayBegin();
+        Document->objectBegin();
+        Document->attributeObject("tool", [&]() {
+            Document->attributeObject("driver", [&]() {
+                Document->attribute("name", "ESSS");
+                Document->attributeArray("rules", [&]() {
+                    for (const auto& rule : Rules) {
+                        Document->object([&]() {
+                            Document->attribute("id", rule.id);
+                            Document->attributeObject("shortDescription", [&]() { Document->attribute("text", rule.description); });
+                            Document->attributeObject("defaultConfiguration", [&]() { Document->attribute("level", rule.level); });
+                        });
+                    }
+                });
+            });
+        });
+        Document->attributeBegin("results");
+        Document->arrayBegin();
+    }
+    return true;
+}
+
+bool isEnabled() {
+    return Enabled;
+}
+
+void intervalValue(json::OStream& json, const Interval& interval) {
+    json.array([&]() {
+        for (const auto& range : interval.getRanges()) {
+            json.array([&]() {
+                json.value(range.low);
+                json.value(range.high);
+            });
+        }
+    });
+}
+
+void attributeInterval(json::OStream& json, StringRef name, const Interval& interval) {
+    json.attributeBegin(name);
+    intervalValue(json, interval);
+    json.attributeEnd();
+}
+
+void locationValue(json::OStream& json, const Location& location) {
+    json.object([&]() {
+        json.attribute("file", location.file);
+        json.attribute("line", static_cast<int64_t>(location.line));
+        if (location.approximate)
+            json.attribute("approximate", true);
+        if (!location.inlinedAtFile.empty()) {
+            json.attributeObject("inlinedAt", [&]() {
+                json.attribute("file", location.inlinedAtFile);
+                json.attribute("line", static_cast<int64_t>(location.inlinedAtLine));
+            });
+        }
+    });
+}
+
+void attributeLocation(json::OStream& json, StringRef name, const Location& location) {
+    if (!location.isValid())
+        return;
+    json.attributeBegin(name);
+    locationValue(json, location);
+    json.attributeEnd();
+}
+
+static StringRef levelOf(StringRef kind) {
+    for (const auto& rule : Rules) {
+        if (rule.id == kind)
+            return rule.level;
+    }
+    return "none";
+}
+
+static void writeSARIFResult(json::OStream& json, StringRef kind, StringRef message, const Location& location,
+                             function_ref<void(json::OStream&)> attributes) {
+    json.object([&]() {
+        json.attribute("ruleId", kind);
+        json.attribute("level", levelOf(kind));
+        json.attributeObject("message", [&]() { json.attribute("text", message); });
+        if (location.isValid()) {
+            json.attributeArray("locations", [&]() {
+                json.object([&]() {
+                    json.attributeObject("physicalLocation", [&]() {
+                        json.attributeObject("artifactLocation", [&]() { json.attribute("uri", location.file); });
+                        json.attributeObject("region", [&]() { json.attribute("startLine", static_cast<int64_t>(location.line)); });
+                    });
+                });
+            });
+        }
+        json.attributeObject("properties", [&]() {
+            if (location.approximate)
+                json.attribute("approximateLocation", true);
+            if (!location.inlinedAtFile.empty()) {
+                Location inlinedAt;
+                inlinedAt.file = location.inlinedAtFile;
+                inlinedAt.line = location.inlinedAtLine;
+                attributeLocation(json, "inlinedAt", inlinedAt);
+            }
+            attributes(json);
+        });
+    });
+}
+
+void write(StringRef kind, StringRef message, const Location& location, function_ref<void(json::OStream&)> attributes) {
+    if (!Enabled)
+        return;
+    lock_guard<mutex> guard(WriteLock);
+    if (OutputFormat == Format::SARIF) {
+        writeSARIFResult(*Document, kind, message, location, attributes);
+    } else {
+        json::OStream json(*Out);
+        json.object([&]() {
+            json.attribute("kind", kind);
+            json.attribute("message", message);
+            attributeLocation(json, "location", location);
+            attributes(json);
+        });
+        *Out << "\n";
+    }
+}
+
+void flush() {
+    if (!Enabled)
+        return;
+    lock_guard<mutex> guard(WriteLock);
+    Out->flush();
+}
+
+bool close(string& error) {
+    if (!Enabled)
+        return true;
+    lock_guard<mutex> guard(WriteLock);
+    Enabled = false;
+    if (Document) {
+        // results, the run, runs and the log
+        Document->arrayEnd();
+        Document->attributeEnd();
+        Document->objectEnd();
+        Document->arrayEnd();
+        Document->attributeEnd();
+        Document->objectEnd();
+        Document.reset();
+        *Out << "\n";
+    }
+    Out->close();
+    bool failed = Out->has_error();
+    if (failed) {
+        error = Out->error().message();
+        Out->clear_error();
+    }
+    Out.reset();
+    return !failed;
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/Support/JSON.h>
+
+class Interval;
+
+/**
+ * Structured output of the learned error specifications, the safety checks and the bug reports, next to the text
+ * output. Records are streamed to the file as they are produced, either as JSON Lines (one object per line, with the
+ * rule in "kind") or as a SARIF 2.1.0 log (one result per record, with the other fields in "properties").
+ * When no file is open, records are dropped and only a flag is tested. Thread-safe.
+ */
+namespace ReportWriter {
+
+enum class Format {
+    JSONLines,
+    SARIF,
+};
+
+// Source location of a record, taken from the debug information
+struct Location {
+    llvm::StringRef file;
+    unsigned int line = 0;
+    // The line of the function, because the instruction has no debug location
+    bool approximate = false;
+    llvm::StringRef inlinedAtFile;
+    unsigned int inlinedAtLine = 0;
+
+    static Location of(const llvm::Instruction* instruction, bool followInlines = true);
+    static Location of(const llvm::Function* function);
+    [[nodiscard]] bool isValid() const { return !file.empty(); }
+};
+
+// Returns false and sets the error message if the file cannot be created
+bool open(llvm::StringRef path, Format format, std::string& error);
+[[nodiscard]] bool isEnabled();
+
+// Writes a record of the rule kind. The attributes callback adds the rule specific fields.
+void write(llvm::StringRef kind, llvm::StringRef message, const Location& location,
+           llvm::function_ref<void(llvm::json::OStream&)> attributes);
+
+// Helpers for the attributes. An interval is an array of [low, high] ranges.
+void intervalValue(llvm::json::OStream& json, const Interval& interval);
+void attributeInterval(llvm::json::OStream& json, llvm::StringRef name, const Interval& interval);
+void locationValue(llvm::json::OStream& json, const Location& location);
+// Omitted if the location is unknown
+void attributeLocation(llvm::json::OStream& json, llvm::StringRef name, const Location& location);
+
+// Writes out the buffered records, such that readers of the file see them right away
+void flush();
+
+// Completes the file. Returns false and sets the error message if writing failed.
+bool close(std::string& error);
+
+}
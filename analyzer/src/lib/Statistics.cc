@@ -0,0 +1,145 @@
+#include <chrono>
+#include <vector>
+#include <sys/resource.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+#include "Statistics.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace Statistics {
+
+bool Enabled = false;
+
+void enable() {
+    Enabled = true;
+}
+
+StatisticCounter PathsEnumerated("paths enumerated", "Paths collected from error checks and error blocks");
+StatisticCounter SummariesCompared("summaries compared", "Pairs of path summaries compared for common error handling");
+StatisticCounter AliasQueries("alias queries", "Queries to the alias analysis");
+StatisticCounter VSACalls("vsa calls", "Return value set analyses of functions");
+
+static const StatisticCounter* const Counters[] = {&PathsEnumerated, &SummariesCompared, &AliasQueries, &VSACalls};
+
+}
+
+struct Sample {
+    chrono::steady_clock::time_point wall;
+    chrono::nanoseconds cpu;
+    int64_t residentBytes;
+};
+
+struct PhaseRecord {
+    // Including the names of the enclosing phases
+    string name;
+    string label;
+    unsigned int depth;
+    Sample start;
+    chrono::nanoseconds wall {0};
+    chrono::nanoseconds cpu {0};
+    int64_t residentDelta = 0;
+};
+
+static vector<PhaseRecord> Phases;
+static vector<size_t> OpenPhases;
+
+static int64_t currentResidentBytes() {
+    auto statm = MemoryBuffer::getFileAsStream("/proc/self/statm");
+    if (!statm)
+        return 0;
+    // Second field: resident pages
+    auto fields = (*statm)->getBuffer().split(' ').second;
+    int64_t pages;
+    if (fields.split(' ').first.getAsInteger(10, pages))
+        return 0;
+    return pages * sys::Process::getPageSizeEstimate();
+}
+
+static int64_t peakResidentBytes() {
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+static Sample sample() {
+    sys::TimePoint<> elapsed;
+    chrono::nanoseconds user, system;
+    sys::Process::GetTimeUsage(elapsed, user, system);
+    return Sample {chrono::steady_clock::now(), user + system, currentResidentBytes()};
+}
+
+static double toSeconds(chrono::nanoseconds duration) {
+    return chrono::duration<double>(duration).count();
+}
+
+static double toMiB(int64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+PhaseTimer::PhaseTimer(StringRef name) : index(Phases.size()), span(name) {
+    string fullName = OpenPhases.empty() ? name.str() : Phases[OpenPhases.back()].name + " / " + name.str();
+    Phases.push_back(PhaseRecord {std::move(fullName), name.str(), static_cast<unsigned int>(OpenPhases.size()), sample()});
+    OpenPhases.push_back(index);
+}
+
+PhaseTimer::~PhaseTimer() {
+    auto end = sample();
+    auto& phase = Phases[index];
+    phase.wall = chrono::duration_cast<chrono::nanoseconds>(end.wall - phase.start.wall);
+    phase.cpu = end.cpu - phase.start.cpu;
+    phase.residentDelta = end.residentBytes - phase.start.residentBytes;
+    OpenPhases.pop_back();
+}
+
+void Statistics::print(raw_ostream& out) {
+    out << "===== Phase timings =====\n";
+    out << "  Wall (s)    CPU (s)  RSS delta (MiB)  Phase\n";
+    for (const auto& phase : Phases) {
+        out << format("%10.3f %10.3f %16.1f  ", toSeconds(phase.wall), toSeconds(phase.cpu), toMiB(phase.residentDelta));
+        out.indent(2 * phase.depth) << phase.label << "\n";
+    }
+    out << "Peak RSS: " << format("%.1f", toMiB(peakResidentBytes())) << " MiB\n";
+    out << "===== Counters =====\n";
+    for (const auto* counter : Counters)
+        out << format("%14llu", static_cast<unsigned long long>(counter->get())) << "  " << counter->name << " - " << counter->description << "\n";
+}
+
+bool Statistics::writeJSON(StringRef path, string& error) {
+    error_code errorCode;
+    raw_fd_ostream out(path, errorCode);
+    if (errorCode) {
+        error = errorCode.message();
+        return false;
+    }
+    json::OStream json(out, 2);
+    json.object([&]() {
+        json.attributeArray("phases", [&]() {
+            for (const auto& phase : Phases) {
+                json.object([&]() {
+                    json.attribute("name", phase.name);
+                    json.attribute("depth", static_cast<int64_t>(phase.depth));
+                    json.attribute("wall_seconds", toSeconds(phase.wall));
+                    json.attribute("cpu_seconds", toSeconds(phase.cpu));
+                    json.attribute("rss_delta_bytes", phase.residentDelta);
+                });
+            }
+        });
+        json.attributeObject("counters", [&]() {
+            for (const auto* counter : Counters)
+                json.attribute(counter->name, static_cast<int64_t>(counter->get()));
+        });
+        json.attribute("peak_rss_bytes", peakResidentBytes());
+    });
+    out << "\n";
+    if (out.has_error()) {
+        error = out.error().message();
+        out.clear_error();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Trace.h"
+
+namespace Statistics {
+
+// Set before the analysis starts if the statistics are printed or written, increments only test it otherwise.
+extern bool Enabled;
+
+void enable();
+
+}
+
+// Counter of an analysis event. Thread-safe, increments are relaxed.
+class StatisticCounter {
+public:
+    StatisticCounter(const char* name, const char* description) : name(name), description(description) {}
+
+    inline void increment(uint64_t amount = 1) {
+        if (Statistics::Enabled)
+            value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    [[nodiscard]] inline uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+    const char* const name;
+    const char* const description;
+
+private:
+    std::atomic<uint64_t> value {0};
+};
+
+/**
+ * Measures the wall time, the CPU time of the process (all threads) and the change in resident memory of a phase
+ * of the analysis while in scope. Phases opened while another phase is in scope are recorded as its children.
+ * Only the main thread opens phases. Phases are also recorded as trace spans.
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(llvm::StringRef name);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    size_t index;
+    Trace::Span span;
+};
+
+namespace Statistics {
+
+extern StatisticCounter PathsEnumerated;
+extern StatisticCounter SummariesCompared;
+extern StatisticCounter AliasQueries;
+extern StatisticCounter VSACalls;
+
+// Prints the phases and counters in a human readable table.
+void print(llvm::raw_ostream& out);
+
+// Writes the phases and counters as JSON. Returns false and sets the error message on failure.
+bool writeJSON(llvm::StringRef path, std::string& error);
+
+}
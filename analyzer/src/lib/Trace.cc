@@ -0,0 +1,117 @@
+#include <mutex>
+#include <vector>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+#include "Trace.h"
+
+using namespace llvm;
+using namespace std;
+
+namespace Trace {
+
+struct Event {
+    string name;
+    string detail;
+    uint64_t thread;
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point end;
+};
+
+static bool Enabled = false;
+static bool FunctionsEnabled = false;
+static chrono::steady_clock::time_point Origin;
+static uint64_t MainThread;
+static mutex EventsLock;
+static vector<Event> Events;
+
+void enable(bool withFunctions) {
+    Enabled = true;
+    FunctionsEnabled = withFunctions;
+    Origin = chrono::steady_clock::now();
+    MainThread = get_threadid();
+}
+
+bool isEnabled() {
+    return Enabled;
+}
+
+bool isFunctionTracingEnabled() {
+    return FunctionsEnabled;
+}
+
+Span::Span(StringRef name, StringRef detail) {
+    if (!Enabled)
+        return;
+    active = true;
+    this->name = name.str();
+    this->detail = detail.str();
+    start = chrono::steady_clock::now();
+}
+
+Span::~Span() {
+    if (!active)
+        return;
+    auto end = chrono::steady_clock::now();
+    auto thread = get_threadid();
+    lock_guard _(EventsLock);
+    Events.push_back(Event {std::move(name), std::move(detail), thread, start, end});
+}
+
+static int64_t toMicroseconds(chrono::steady_clock::duration duration) {
+    return chrono::duration_cast<chrono::microseconds>(duration).count();
+}
+
+bool write(StringRef path, string& error) {
+    error_code errorCode;
+    raw_fd_ostream out(path, errorCode);
+    if (errorCode) {
+        error = errorCode.message();
+        return false;
+    }
+
+    lock_guard _(EventsLock);
+    // Small, stable thread ids in order of first appearance, the main thread is 0
+    DenseMap<uint64_t, int64_t> threadIds;
+    threadIds[MainThread] = 0;
+    for (const auto& event : Events)
+        threadIds.try_emplace(event.thread, static_cast<int64_t>(threadIds.size()));
+
+    json::OStream json(out);
+    json.object([&]() {
+        json.attributeArray("traceEvents", [&]() {
+            for (const auto& event : Events) {
+                json.object([&]() {
+                    json.attribute("name", event.name);
+                    json.attribute("ph", "X");
+                    json.attribute("pid", 1);
+                    json.attribute("tid", threadIds[event.thread]);
+                    json.attribute("ts", toMicroseconds(event.start - Origin));
+                    json.attribute("dur", toMicroseconds(event.end - event.start));
+                    if (!event.detail.empty())
+                        json.attributeObject("args", [&]() { json.attribute("detail", event.detail); });
+                });
+            }
+            for (int64_t id = 0; id < static_cast<int64_t>(threadIds.size()); ++id) {
+                json.object([&]() {
+                    json.attribute("name", "thread_name");
+                    json.attribute("ph", "M");
+                    json.attribute("pid", 1);
+                    json.attribute("tid", id);
+                    json.attributeObject("args", [&]() { json.attribute("name", id == 0 ? "main" : "worker " + to_string(id)); });
+                });
+            }
+        });
+        json.attribute("displayTimeUnit", "ms");
+    });
+    out << "\n";
+    if (out.has_error()) {
+        error = out.error().message();
+        out.clear_error();
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <llvm/ADT/StringRef.h>
+
+/**
+ * Recorder of Chrome trace events (chrome://tracing, Perfetto), to see how work is spread over the threads.
+ * A span records a complete event from its construction to its destruction on the current thread.
+ * When tracing is disabled, spans only test a flag.
+ */
+namespace Trace {
+
+void enable(bool withFunctions);
+[[nodiscard]] bool isEnabled();
+// Whether per-function spans are recorded as well
+[[nodiscard]] bool isFunctionTracingEnabled();
+
+class Span {
+public:
+    explicit Span(llvm::StringRef name, llvm::StringRef detail = "");
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    bool active = false;
+    std::string name;
+    std::string detail;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Writes the recorded events as JSON. Returns false and sets the error message on failure.
+bool write(llvm::StringRef path, std::string& error);
+
+}
@@ -3,8 +3,11 @@
 import sys
 from collections import defaultdict
 
-# ./check_found_bugs.py <program>
-assert len(sys.argv) == 2
+import common
+
+# ./check_found_bugs.py <program> [<report.jsonl>]
+# Reads the bugs from my-<program>-output, or from a JSON Lines report of kanalyzer --report-file if given.
+assert len(sys.argv) in (2, 3)
 
 program = sys.argv[1]
 
@@ -31,21 +34,33 @@ prefix_counters = defaultdict(int)
 category_mapper = defaultdict(set)
 uncategorised_total = list()
 
+prefixes = ('Potential bug, not all error values are checked for the following call: ', 'Potential bug, truncation of error values: ', 'Potential bug, signedness bug: ', 'Potential bug, missing check for the following call: ')
+bug_type_names = ('I', 'T', 'S', 'M')
+record_kinds = ('incorrect-check', 'truncation', 'signedness', 'missing-check')
+
+def found_bugs():
+    """Yields the prefix and the identifier of every reported bug."""
+    if len(sys.argv) == 3:
+        for record in common.read_report_records(sys.argv[2]):
+            if record['kind'] in record_kinds:
+                yield prefixes[record_kinds.index(record['kind'])], common.report_identifier(record)
+    else:
+        for line in open(f'my-{program}-output'):
+            for prefix in prefixes:
+                if line.startswith(prefix):
+                    yield prefix, line[len(prefix):].rstrip()
+
 found_bugs_set = set()
-for line in open(f'my-{program}-output'):
-    prefixes = ('Potential bug, not all error values are checked for the following call: ', 'Potential bug, truncation of error values: ', 'Potential bug, signedness bug: ', 'Potential bug, missing check for the following call: ')
-    bug_type_names = ('I', 'T', 'S', 'M')
-    for (prefix, bug_type_name) in zip(prefixes, bug_type_names):
-        if line.startswith(prefix):
-            prefix_counters[prefix] += 1
-            identifier = line[len(prefix):].rstrip()
-            found_bugs_set.add(identifier)
-
-            if identifier in bug_map:
-                category_mapper[bug_map[identifier]].add(identifier)
-            else:
-                category_mapper[f'{bug_type_name}_UC'].add(identifier)
-                uncategorised_total.append(identifier)
+for prefix, identifier in found_bugs():
+    bug_type_name = bug_type_names[prefixes.index(prefix)]
+    prefix_counters[prefix] += 1
+    found_bugs_set.add(identifier)
+
+    if identifier in bug_map:
+        category_mapper[bug_map[identifier]].add(identifier)
+    else:
+        category_mapper[f'{bug_type_name}_UC'].add(identifier)
+        uncategorised_total.append(identifier)
 
 not_found_bugs_set_PT = expected_bugs_set_PT.difference(found_bugs_set)
 not_found_bugs_set_AorC = expected_bugs_set_AorC.difference(found_bugs_set)
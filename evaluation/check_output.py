@@ -2,10 +2,16 @@
 
 import sys
 
+import common
+
 # ./check_output.py <gotten output (file)> <expected output (file)>
+# Either file can also be a JSON Lines report (.jsonl) of kanalyzer --ssc --report-file
 assert len(sys.argv) == 3
 
 def extract_checks(filename):
+    if filename.endswith('.jsonl'):
+        return set(f"{record['condition']}\n{common.report_identifier(record)}"
+                   for record in common.read_report_records(filename) if record['kind'] == 'safety-check')
     lines = []
     marked = False
     for line in open(filename):
@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import json
 import re
 
 
@@ -34,6 +35,28 @@ def extracted_checks_to_function_names(checks):
     result = extracted_checks_to_dict(checks)
     return set(result.keys())
 
+def read_report_records(filename):
+    """Yields the records of kanalyzer --report-file (JSON Lines format)."""
+    with open(filename) as f:
+        for line in f:
+            yield json.loads(line)
+
+def report_identifier(record):
+    """The location of a record as in the text output, e.g. the identifier after 'Potential bug, ...: '."""
+    if record['kind'] == 'truncation':
+        return f"{record['caller']} -> {record['callee']}"
+    if record['kind'] == 'signedness':
+        return record['function']
+    location = record.get('location')
+    if not location:
+        return '?: ?'
+    if location.get('approximate'):
+        return f"{location['file']}: ~{location['line']}~"
+    inlined_at = location.get('inlinedAt')
+    if inlined_at:
+        return f"{location['file']}: {location['line']} (inlined at {inlined_at['file']}: {inlined_at['line']})"
+    return f"{location['file']}: {location['line']}"
+
 def read_lines_to_set(filename):
     return set(line.rstrip() for line in open(filename))
 
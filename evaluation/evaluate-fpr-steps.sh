@@ -5,11 +5,16 @@ if [ $# -ne 1 ]; then
     exit 1
 fi
 
-for threshold in $(seq 0.725 0.01 0.995); do
-    "./run-my-$1.sh" $threshold &> "my-$1-output"
+# Score the reports once and write the reports for every threshold, instead of running the analysis per threshold
+thresholds=$(seq 0.725 0.01 0.995)
+sweep_dir="$(pwd)/sweep-$1"
+KANALYZER_EXTRA_ARGS="$KANALYZER_EXTRA_ARGS --sweep-missing-ct=$(echo $thresholds | tr ' ' ',') --sweep-output=$sweep_dir" \
+    "./run-my-$1.sh" &> "my-$1-sweep-output"
+
+for threshold in $thresholds; do
+    cp "$sweep_dir/missing-ct-$(printf '%.3f' "$threshold")" "my-$1-output"
     #./compute_my_stats.py "$1"
     echo "At threshold: $threshold"
     ./check_found_bugs.py "$1" | grep -E 'FPR:|M total '
     echo '----------------------------------'
 done
-wait
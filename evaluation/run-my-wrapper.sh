@@ -13,9 +13,10 @@ pushd "$1"
 # NOTE: analyzing the whole combined.bc file instead of separate modules should give the same result,
 #       but the advantage of using separate modules is that we can process them in parallel
 # NOTE: for sampling: --print-random-non-void-function-samples 250
+# NOTE: extra analyzer options can be passed through KANALYZER_EXTRA_ARGS, e.g. KANALYZER_EXTRA_ARGS=--release-memory
 missing_ct="$4"
 if [ "$missing_ct" == "" ]; then
     missing_ct="0.725"
 fi
-/usr/bin/time --format='time=%E memory=%M' -- "$ANALYZER" -c 1 --missing-ct="$missing_ct" --function-test-cases-to-analyzer="$3" --verbose-level=0 "$2" tmp/* tmp/.*
+/usr/bin/time --format='time=%E memory=%M' -- "$ANALYZER" -c 1 --missing-ct="$missing_ct" --function-test-cases-to-analyzer="$3" --verbose-level=0 $KANALYZER_EXTRA_ARGS "$2" tmp/* tmp/.*
 popd
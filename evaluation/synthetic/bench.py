@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+End-to-end throughput suite on synthetic programs from generate.py.
+
+For every size, generates a program (options not listed below are passed on to generate.py), compiles it with clang
+when --frontend=clang (otherwise the generated LLVM IR is analyzed directly), and runs kanalyzer once for every thread
+count. Records the wall time, the throughput in analyzed functions per second and the peak resident memory of every
+run, and spot checks the inferred error specifications against the planted ones.
+The results are printed and written to <output>/results.csv.
+"""
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import time
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(SCRIPT_DIRECTORY))
+import common  # noqa: E402
+
+
+def ranges(text):
+    return [(int(low), int(high)) for low, high in re.findall(r'\[(-?\d+), (-?\d+)\]', text)]
+
+
+def contains(intervals, value):
+    return any(low <= value <= high for low, high in intervals)
+
+
+def spot_check(directory, output):
+    """Returns the number of recovered planted specifications, the planted specifications that were not recovered,
+    the number of reported planted bugs, the number of planted bugs and the number of reported bugs.
+    A specification is recovered when the inferred interval contains the planted error codes, but not 0."""
+    inferred = common.extracted_checks_to_dict(common.extract_checks(output))
+    recovered = 0
+    missed = []
+    for line in open(os.path.join(directory, 'planted-specs')):
+        function, planted = line.rstrip('\n').split('\t')
+        (low, high), = ranges(planted)
+        intervals = ranges(inferred.get(function, ''))
+        if contains(intervals, low) and contains(intervals, high) and not contains(intervals, 0):
+            recovered += 1
+        else:
+            missed.append((function, planted, inferred.get(function)))
+
+    planted_bugs = common.read_lines_to_set(os.path.join(directory, 'planted-bugs'))
+    reported = set(line.split(': ', 1)[1].strip() for line in open(output) if line.startswith('Potential bug'))
+    return recovered, missed, len(planted_bugs & reported), len(planted_bugs), len(reported)
+
+
+def run_analyzer(command, output):
+    """Runs the analyzer and returns its wall time in seconds and its peak resident memory in MiB."""
+    with open(output, 'w') as out:
+        start = time.monotonic()
+        process = subprocess.Popen(command, stdout=out, stderr=subprocess.STDOUT)
+        _, status, usage = os.wait4(process.pid, 0)
+        seconds = time.monotonic() - start
+    # Reaped by wait4, so the Popen object must not wait for it again
+    process.returncode = os.waitstatus_to_exitcode(status)
+    if process.returncode != 0:
+        raise SystemExit(f'{" ".join(command)} failed with exit code {process.returncode}, see {output}')
+    return seconds, usage.ru_maxrss / 1024
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--analyzer', default=os.path.join(SCRIPT_DIRECTORY, '../../analyzer/build/lib/kanalyzer'))
+    parser.add_argument('--output', default='synthetic-bench', help='directory for the programs and the results')
+    parser.add_argument('--sizes', default='2000,8000,32000', help='comma separated numbers of user functions')
+    parser.add_argument('--threads', default='1,2,4', help='comma separated thread counts, passed as -c')
+    parser.add_argument('--frontend', choices=['ll', 'clang'], default='ll',
+                        help='analyze the generated IR, or the bitcode compiled from the generated C with clang')
+    parser.add_argument('--cc', default='clang')
+    parser.add_argument('--cflags', default='-g -O2 -fno-inline')
+    parser.add_argument('--analyzer-args', default='', help='extra analyzer options, e.g. --release-memory')
+    parser.add_argument('--min-recall', type=float, default=0.95,
+                        help='fails when fewer planted specifications than this fraction are recovered')
+    args, generator_args = parser.parse_known_args()
+
+    analyzer = os.path.abspath(args.analyzer)
+    output_directory = os.path.abspath(args.output)
+    os.makedirs(output_directory, exist_ok=True)
+
+    results = []
+    failed = False
+    for size in [int(size) for size in args.sizes.split(',')]:
+        directory = os.path.join(output_directory, f'size-{size}')
+        subprocess.run([sys.executable, os.path.join(SCRIPT_DIRECTORY, 'generate.py'), '--output', directory,
+                        '--functions', str(size)] + generator_args, check=True)
+        modules = sorted(name[:-len('.c')] for name in os.listdir(directory) if re.fullmatch(r'synthetic_\d+\.c', name))
+        if args.frontend == 'clang':
+            inputs = []
+            for module in modules:
+                bitcode = os.path.join(directory, f'{module}.bc')
+                subprocess.run([args.cc] + args.cflags.split() + ['-c', '-emit-llvm', '-o', bitcode,
+                                                                  os.path.join(directory, f'{module}.c')], check=True)
+                inputs.append(bitcode)
+        else:
+            inputs = [os.path.join(directory, f'{module}.ll') for module in modules]
+        functions = size + sum(1 for _ in open(os.path.join(directory, 'planted-specs')))
+
+        for threads in [int(threads) for threads in args.threads.split(',')]:
+            output = os.path.join(directory, f'threads-{threads}.txt')
+            command = [analyzer, '-c', str(threads), '--verbose-level=0'] + args.analyzer_args.split() + inputs
+            seconds, peak_rss = run_analyzer(command, output)
+            recovered, missed, planted_bugs_reported, planted_bugs, reports = spot_check(directory, output)
+            planted = recovered + len(missed)
+            if recovered < args.min_recall * planted:
+                failed = True
+                print(f'Spot check failed for size {size} with {threads} threads, for example:', file=sys.stderr)
+                for function, expected, actual in missed[:10]:
+                    print(f'  {function}: planted {expected}, inferred {actual}', file=sys.stderr)
+            results.append({
+                'functions': functions, 'modules': len(modules), 'threads': threads,
+                'seconds': f'{seconds:.2f}', 'functions_per_second': f'{functions / seconds:.0f}',
+                'peak_rss_mib': f'{peak_rss:.0f}', 'specs_recovered': recovered, 'specs_planted': planted,
+                'reports': reports, 'planted_bugs_reported': planted_bugs_reported, 'planted_bugs': planted_bugs,
+            })
+            print(f'{functions:>9} functions {threads:>3} threads {seconds:>9.2f} s '
+                  f'{functions / seconds:>9.0f} functions/s {peak_rss:>7.0f} MiB peak RSS, '
+                  f'{recovered}/{planted} specs recovered, {planted_bugs_reported}/{planted_bugs} planted bugs reported')
+
+    with open(os.path.join(output_directory, 'results.csv'), 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=list(results[0].keys()))
+        writer.writeheader()
+        writer.writerows(results)
+    print(f'Results written to {os.path.join(output_directory, "results.csv")}')
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,400 @@
+#!/usr/bin/env python3
+"""
+Generates a synthetic C program, and the equivalent LLVM IR, with planted error specifications.
+
+The program consists of:
+  * error-returning APIs, api_<i>, that return one or two planted negative error codes,
+  * layers of wrappers, wrap_<level>_<i>, that forward or propagate the error codes of the layer below,
+  * indirect-call tables of APIs per module,
+  * user functions, user_<i>, that call APIs, wrappers and tables and check the results in one of the check styles,
+    with independent branches in between that multiply the number of paths.
+A small fraction of the call sites is left unchecked or checked the wrong way, these are the planted bugs.
+
+Output, in the output directory:
+  * synthetic.h and synthetic_<m>.c: the C program, to compile with clang -g -c -emit-llvm,
+  * synthetic_<m>.ll: the same program as LLVM IR with debug locations, which can be analyzed without a C toolchain,
+  * planted-specs: the planted error intervals of the APIs and wrappers, in the analyzer's output format,
+  * planted-bugs: the locations of the planted bugs, in the analyzer's output format.
+"""
+
+import argparse
+import os
+import random
+from dataclasses import dataclass, field
+from typing import List, Optional, Union
+
+CHECK_STYLES = ['lt', 'ne', 'switch', 'goto']
+BUG_STYLES = ['ignored', 'wrong']
+
+
+@dataclass
+class Api:
+    name: str
+    module: int
+    codes: List[int]
+
+
+@dataclass
+class Wrapper:
+    name: str
+    module: int
+    callee: Union[Api, 'Wrapper']
+    propagate: bool
+    codes: List[int]
+    line: int = 0
+
+
+@dataclass
+class Table:
+    name: str
+    module: int
+    entries: List[Api]
+    codes: List[int]
+
+
+@dataclass
+class Site:
+    target: Union[Api, Wrapper, Table]
+    style: str
+    branch: Optional[int]
+    line: int = 0
+
+
+@dataclass
+class User:
+    name: str
+    module: int
+    sites: List[Site] = field(default_factory=list)
+
+
+@dataclass
+class Program:
+    modules: int
+    apis: List[Api]
+    wrappers: List[Wrapper]
+    tables: List[Table]
+    users: List[User]
+
+
+def interval(codes):
+    return f'[{min(codes)}, {max(codes)}]'
+
+
+def build_program(args):
+    rng = random.Random(args.seed)
+    modules = args.modules or max(1, args.functions // 500)
+    api_count = args.apis or max(4, args.functions // 8)
+
+    apis = []
+    for i in range(api_count):
+        base = 1 + (i * 3) % 20
+        count = 2 if i % 3 == 0 else 1
+        apis.append(Api(f'api_{i}', i % modules, [-(base + k) for k in range(count)]))
+
+    wrappers = []
+    layer = apis
+    for level in range(1, args.depth + 1):
+        next_layer = []
+        for i in range(max(2, args.functions // 16)):
+            callee = rng.choice(layer)
+            wrapper = Wrapper(f'wrap_{level}_{i}', (level + i) % modules, callee, rng.random() < 0.5, callee.codes)
+            next_layer.append(wrapper)
+        wrappers.extend(next_layer)
+        layer = next_layer
+
+    tables = []
+    for module in range(modules if args.indirect_rate > 0 else 0):
+        for t in range(args.tables):
+            entries = [rng.choice(apis) for _ in range(4)]
+            codes = sorted(set(code for api in entries for code in api.codes))
+            tables.append(Table(f'table_{module}_{t}', module, entries, codes))
+
+    styles = [style for style in args.check_styles.split(',') if style]
+    for style in styles:
+        if style not in CHECK_STYLES:
+            raise SystemExit(f'Unknown check style: {style}, expected one of {", ".join(CHECK_STYLES)}')
+    callees = apis + wrappers
+
+    users = []
+    for i in range(args.functions):
+        user = User(f'user_{i}', i % modules)
+        module_tables = [table for table in tables if table.module == user.module]
+        branch = 0
+        for _ in range(rng.randint(1, 2 * args.sites - 1)):
+            if module_tables and rng.random() < args.indirect_rate:
+                target = rng.choice(module_tables)
+            else:
+                target = rng.choice(callees)
+            style = rng.choice(BUG_STYLES) if rng.random() < args.bug_rate else rng.choice(styles)
+            site_branch = None
+            if rng.random() < args.branchiness:
+                site_branch = branch
+                branch += 1
+            user.sites.append(Site(target, style, site_branch))
+        users.append(user)
+
+    return Program(modules, apis, wrappers, tables, users)
+
+
+def file_name(module):
+    return f'synthetic_{module}.c'
+
+
+# C emission. Assigns the line numbers of the wrappers and the call sites, which the IR reuses as debug locations.
+
+def c_call(target):
+    if isinstance(target, Table):
+        return f'{target.name}[flags & 3]()'
+    return f'{target.name}()'
+
+
+def emit_c_header(program):
+    lines = ['#pragma once', '',
+             'int generate_error(void);', 'void log_error(void);', 'void release_resources(void);',
+             'void do_something(int value);', '']
+    lines += [f'int {function.name}(void);' for function in program.apis + program.wrappers]
+    lines += [f'int {user.name}(int flags);' for user in program.users]
+    return '\n'.join(lines) + '\n'
+
+
+def emit_c_module(program, module):
+    lines = ['#include "synthetic.h"', '']
+
+    for api in program.apis:
+        if api.module != module:
+            continue
+        lines.append(f'int {api.name}(void) {{')
+        for code in api.codes:
+            lines += ['    if (generate_error() != 0) {', '        log_error();', f'        return {code};', '    }']
+        lines += ['    return 0;', '}', '']
+
+    for wrapper in program.wrappers:
+        if wrapper.module != module:
+            continue
+        lines.append(f'int {wrapper.name}(void) {{')
+        if wrapper.propagate:
+            wrapper.line = len(lines) + 1
+            lines += [f'    int r = {c_call(wrapper.callee)};', '    if (r < 0)', '        return r;',
+                      '    do_something(0);', '    return 0;']
+        else:
+            wrapper.line = len(lines) + 1
+            lines.append(f'    return {c_call(wrapper.callee)};')
+        lines += ['}', '']
+
+    for table in program.tables:
+        if table.module != module:
+            continue
+        entries = ', '.join(api.name for api in table.entries)
+        lines += [f'static int (*const {table.name}[4])(void) = {{{entries}}};', '']
+
+    for user in program.users:
+        if user.module != module:
+            continue
+        lines += [f'int {user.name}(int flags) {{', '    int r;']
+        for site in user.sites:
+            if site.style == 'ignored':
+                site.line = len(lines) + 1
+                lines.append(f'    {c_call(site.target)};')
+            else:
+                site.line = len(lines) + 1
+                lines.append(f'    r = {c_call(site.target)};')
+                if site.style == 'switch':
+                    lines.append('    switch (r) {')
+                    lines += [f'    case {code}:' for code in site.target.codes]
+                    lines += ['        log_error();', '        return -1;', '    default:', '        break;', '    }']
+                elif site.style == 'goto':
+                    lines += ['    if (r < 0)', '        goto cleanup;']
+                else:
+                    condition = {'lt': 'r < 0', 'ne': 'r != 0', 'wrong': 'r > 0'}[site.style]
+                    lines += [f'    if ({condition}) {{', '        log_error();', '        return -1;', '    }']
+            if site.branch is not None:
+                lines += [f'    if (flags & {1 << (site.branch % 31)})', f'        do_something({site.branch});']
+        lines.append('    return 0;')
+        if any(site.style == 'goto' for site in user.sites):
+            lines += ['cleanup:', '    release_resources();', '    log_error();', '    return -1;']
+        lines += ['}', '']
+
+    return '\n'.join(lines) + '\n'
+
+
+# LLVM IR emission
+
+class IRModule:
+    def __init__(self, program, module, directory):
+        self.program = program
+        self.module = module
+        self.directory = directory
+        self.metadata = []
+        self.next_id = 0
+        self.declared = set()
+        self.functions = []
+        self.file = self.new_metadata(f'!DIFile(filename: "{file_name(module)}", directory: "{directory}")')
+        self.unit = self.new_metadata(f'distinct !DICompileUnit(language: DW_LANG_C99, file: !{self.file}, '
+                                      f'producer: "synthetic", isOptimized: false, runtimeVersion: 0, '
+                                      f'emissionKind: FullDebug)')
+        self.type = self.new_metadata('!DISubroutineType(types: !{})')
+
+    def new_metadata(self, text):
+        identifier = self.next_id
+        self.next_id += 1
+        self.metadata.append(f'!{identifier} = {text}')
+        return identifier
+
+    def subprogram(self, name):
+        return self.new_metadata(f'distinct !DISubprogram(name: "{name}", scope: !{self.file}, file: !{self.file}, '
+                                 f'type: !{self.type}, spFlags: DISPFlagDefinition, unit: !{self.unit})')
+
+    def location(self, line, scope):
+        return self.new_metadata(f'!DILocation(line: {line}, scope: !{scope})')
+
+    def reference(self, function):
+        if function.module != self.module:
+            self.declared.add(function.name)
+        return f'@{function.name}'
+
+    def call(self, result, target, flags, line, scope):
+        prefix = f'{result} = ' if result else ''
+        location = self.location(line, scope)
+        if isinstance(target, Table):
+            index = result.lstrip('%') if result else f'i{line}'
+            return [f'  %{index}.index = and i32 {flags}, 3',
+                    f'  %{index}.index64 = zext i32 %{index}.index to i64',
+                    f'  %{index}.slot = getelementptr inbounds [4 x i32 ()*], [4 x i32 ()*]* @{target.name}, '
+                    f'i64 0, i64 %{index}.index64',
+                    f'  %{index}.callee = load i32 ()*, i32 ()** %{index}.slot',
+                    f'  {prefix}call i32 %{index}.callee(), !dbg !{location}']
+        return [f'  {prefix}call i32 {self.reference(target)}(), !dbg !{location}']
+
+    def emit_api(self, api):
+        scope = self.subprogram(api.name)
+        lines = [f'define i32 @{api.name}() !dbg !{scope} {{', 'entry:']
+        for k, code in enumerate(api.codes):
+            lines += [f'  %g{k} = call i32 @generate_error()', f'  %c{k} = icmp ne i32 %g{k}, 0',
+                      f'  br i1 %c{k}, label %fail{k}, label %ok{k}',
+                      f'fail{k}:', '  call void @log_error()', f'  ret i32 {code}', f'ok{k}:']
+        lines += ['  ret i32 0', '}']
+        self.functions.append('\n'.join(lines))
+
+    def emit_wrapper(self, wrapper):
+        scope = self.subprogram(wrapper.name)
+        lines = [f'define i32 @{wrapper.name}() !dbg !{scope} {{', 'entry:']
+        lines += self.call('%r', wrapper.callee, None, wrapper.line, scope)
+        if wrapper.propagate:
+            lines += ['  %c = icmp slt i32 %r, 0', '  br i1 %c, label %fail, label %ok',
+                      'fail:', '  ret i32 %r', 'ok:', '  call void @do_something(i32 0)', '  ret i32 0']
+        else:
+            lines.append('  ret i32 %r')
+        lines.append('}')
+        self.functions.append('\n'.join(lines))
+
+    def emit_table(self, table):
+        entries = ', '.join(f'i32 ()* {self.reference(api)}' for api in table.entries)
+        self.functions.append(f'@{table.name} = internal constant [4 x i32 ()*] [{entries}]')
+
+    def emit_user(self, user):
+        scope = self.subprogram(user.name)
+        lines = [f'define i32 @{user.name}(i32 %flags) !dbg !{scope} {{', 'entry:']
+        for s, site in enumerate(user.sites):
+            next_block = f'next{s}'
+            if site.style == 'ignored':
+                lines += self.call(None, site.target, '%flags', site.line, scope)
+                lines.append(f'  br label %{next_block}')
+            else:
+                lines += self.call(f'%r{s}', site.target, '%flags', site.line, scope)
+                if site.style == 'switch':
+                    cases = ' '.join(f'i32 {code}, label %fail{s}' for code in site.target.codes)
+                    lines.append(f'  switch i32 %r{s}, label %{next_block} [ {cases} ]')
+                else:
+                    predicate = {'lt': 'slt', 'ne': 'ne', 'goto': 'slt', 'wrong': 'sgt'}[site.style]
+                    fail = 'cleanup' if site.style == 'goto' else f'fail{s}'
+                    lines += [f'  %c{s} = icmp {predicate} i32 %r{s}, 0',
+                              f'  br i1 %c{s}, label %{fail}, label %{next_block}']
+                if site.style != 'goto':
+                    lines += [f'fail{s}:', '  call void @log_error()', '  ret i32 -1']
+            lines.append(f'{next_block}:')
+            if site.branch is not None:
+                lines += [f'  %b{s} = and i32 %flags, {1 << (site.branch % 31)}', f'  %bc{s} = icmp ne i32 %b{s}, 0',
+                          f'  br i1 %bc{s}, label %then{s}, label %join{s}',
+                          f'then{s}:', f'  call void @do_something(i32 {site.branch})', f'  br label %join{s}',
+                          f'join{s}:']
+        lines.append('  ret i32 0')
+        if any(site.style == 'goto' for site in user.sites):
+            lines += ['cleanup:', '  call void @release_resources()', '  call void @log_error()', '  ret i32 -1']
+        lines.append('}')
+        self.functions.append('\n'.join(lines))
+
+    def render(self):
+        program = self.program
+        for table in program.tables:
+            if table.module == self.module:
+                self.emit_table(table)
+        for api in program.apis:
+            if api.module == self.module:
+                self.emit_api(api)
+        for wrapper in program.wrappers:
+            if wrapper.module == self.module:
+                self.emit_wrapper(wrapper)
+        for user in program.users:
+            if user.module == self.module:
+                self.emit_user(user)
+
+        declarations = ['declare i32 @generate_error()', 'declare void @log_error()',
+                        'declare void @release_resources()', 'declare void @do_something(i32)']
+        declarations += [f'declare i32 @{name}()' for name in sorted(self.declared)]
+        flags_begin = self.next_id
+        self.new_metadata('!{i32 7, !"Dwarf Version", i32 4}')
+        self.new_metadata('!{i32 2, !"Debug Info Version", i32 3}')
+        header = [f'; ModuleID = \'{file_name(self.module)}\'', f'source_filename = "{file_name(self.module)}"', '']
+        footer = [f'!llvm.dbg.cu = !{{!{self.unit}}}', f'!llvm.module.flags = !{{!{flags_begin}, !{flags_begin + 1}}}']
+        return '\n'.join(header + declarations + [''] + self.functions + [''] + footer + self.metadata) + '\n'
+
+
+def write(path, text):
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--output', required=True, help='output directory')
+    parser.add_argument('--functions', type=int, default=1000, help='number of user functions')
+    parser.add_argument('--modules', type=int, default=0, help='number of modules, defaults to one per 500 functions')
+    parser.add_argument('--apis', type=int, default=0, help='number of error-returning APIs, defaults to 1/8th of the functions')
+    parser.add_argument('--depth', type=int, default=3, help='number of wrapper layers above the APIs')
+    parser.add_argument('--sites', type=int, default=3, help='average number of call sites per user function')
+    parser.add_argument('--check-styles', default=','.join(CHECK_STYLES),
+                        help=f'comma separated check styles of the call sites, out of {", ".join(CHECK_STYLES)}')
+    parser.add_argument('--tables', type=int, default=2, help='number of indirect-call tables per module')
+    parser.add_argument('--indirect-rate', type=float, default=0.1, help='fraction of call sites through a table')
+    parser.add_argument('--branchiness', type=float, default=0.5,
+                        help='fraction of call sites followed by an independent branch, each doubles the paths')
+    parser.add_argument('--bug-rate', type=float, default=0.03, help='fraction of call sites with a planted bug')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    program = build_program(args)
+    directory = os.path.abspath(args.output)
+    os.makedirs(directory, exist_ok=True)
+
+    write(os.path.join(directory, 'synthetic.h'), emit_c_header(program))
+    for module in range(program.modules):
+        write(os.path.join(directory, file_name(module)), emit_c_module(program, module))
+    for module in range(program.modules):
+        write(os.path.join(directory, f'synthetic_{module}.ll'), IRModule(program, module, directory).render())
+
+    with open(os.path.join(directory, 'planted-specs'), 'w') as f:
+        for function in sorted(program.apis + program.wrappers, key=lambda function: function.name):
+            f.write(f'{function.name}\t{interval(function.codes)}\n')
+    with open(os.path.join(directory, 'planted-bugs'), 'w') as f:
+        for user in program.users:
+            for site in user.sites:
+                if site.style in BUG_STYLES:
+                    f.write(f'{file_name(user.module)}: {site.line}\n')
+
+    sites = sum(len(user.sites) for user in program.users)
+    print(f'Generated {program.modules} modules with {len(program.apis)} APIs, {len(program.wrappers)} wrappers, '
+          f'{len(program.tables)} tables, {len(program.users)} user functions and {sites} call sites in {directory}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Checks that --lazy-load gives the same output as loading every input eagerly.
+
+Generates a synthetic program with generate.py (options not listed below are passed on to generate.py), assembles
+its modules to bitcode with llvm-as, since only bitcode is loaded lazily, and runs kanalyzer once on all modules
+eagerly and once with the modules matching --lazy-load loaded lazily. The two outputs must only differ in the
+"Lazily loaded" summary line. Function records and the candidate intervals within them are compared regardless of
+their order, which depends on the hashing of pointers and differs between any two runs.
+"""
+
+import argparse
+import difflib
+import os
+import re
+import subprocess
+import sys
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+
+
+def records(filename):
+    """The output as sorted records: a line that is not indented, followed by its indented lines, grouped by the
+    interval that a confidence line belongs to."""
+    result = []
+    for line in open(filename):
+        line = line.rstrip('\n')
+        if line.startswith(('\t', ' ')) and result:
+            groups = result[-1][1]
+            if not line.lstrip().startswith('Confidence') or not groups:
+                groups.append([line])
+            else:
+                groups[-1].append(line)
+        else:
+            result.append((line, []))
+    return sorted('\n'.join([header] + sorted('\n'.join(group) for group in groups))
+                  for header, groups in result if not header.startswith('Lazily loaded'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--analyzer', default=os.path.join(SCRIPT_DIRECTORY, '../../analyzer/build/lib/kanalyzer'))
+    parser.add_argument('--llvm-as', default='llvm-as')
+    parser.add_argument('--output', default='lazy-load-equivalence', help='directory for the program and the outputs')
+    parser.add_argument('--functions', default='2000', help='number of user functions')
+    parser.add_argument('--lazy-load', default='synthetic_1,synthetic_2', help='passed on to kanalyzer')
+    args, generator_args = parser.parse_known_args()
+
+    directory = os.path.abspath(args.output)
+    subprocess.run([sys.executable, os.path.join(SCRIPT_DIRECTORY, 'generate.py'), '--output', directory,
+                    '--functions', args.functions] + generator_args, check=True)
+    modules = sorted(name[:-len('.ll')] for name in os.listdir(directory) if re.fullmatch(r'synthetic_\d+\.ll', name))
+    inputs = []
+    for module in modules:
+        bitcode = os.path.join(directory, f'{module}.bc')
+        subprocess.run([args.llvm_as, '-o', bitcode, os.path.join(directory, f'{module}.ll')], check=True)
+        inputs.append(bitcode)
+
+    outputs = {}
+    for name, options in [('eager', []), ('lazy', [f'--lazy-load={args.lazy_load}'])]:
+        outputs[name] = os.path.join(directory, f'{name}.txt')
+        with open(outputs[name], 'w') as out:
+            subprocess.run([args.analyzer, '-c', '1'] + options + inputs, stdout=out, stderr=subprocess.STDOUT, check=True)
+
+    if not any(line.startswith('Lazily loaded') for line in open(outputs['lazy'])):
+        print(f'No input matched --lazy-load={args.lazy_load}', file=sys.stderr)
+        return 1
+    eager, lazy = records(outputs['eager']), records(outputs['lazy'])
+    if eager != lazy:
+        print(f'The outputs differ, see {outputs["eager"]} and {outputs["lazy"]}:', file=sys.stderr)
+        for line in list(difflib.unified_diff(eager, lazy, 'eager', 'lazy', lineterm=''))[:40]:
+            print(line, file=sys.stderr)
+        return 1
+    print(f'{len(eager)} output records are the same with and without --lazy-load={args.lazy_load}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())